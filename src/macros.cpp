@@ -14,6 +14,8 @@
 /*    You should have received a copy of the GNU General Public License     */
 /*    along with this program.  If not, see <http://www.gnu.org/licenses/>. */
 /*****************************************************************************/
+#include <algorithm>
+#include <climits>
 #include <cstdarg>
 #include <cstdlib>
 #include <cstring>
@@ -31,17 +33,19 @@
 #include "mdl_builtin_types.h"
 #include "mdl_builtins.h"
 #include "mdl_assoc.hpp"
+#include "mdl_compile.hpp"
 #include "mdl_strbuf.h"
 
 #define DECODE_TENEX_FILESPECS
 
 mdl_built_in_table_t built_in_table;
 mdl_type_table_t mdl_type_table;
-mdl_symbol_table_t global_syms;
+mdl_global_atoms_t global_syms;
+unsigned mdl_global_epoch = 1;
+size_t mdl_global_reads = 0;
 
 mdl_frame_t *cur_frame = nullptr;
 mdl_frame_t *initial_frame = nullptr;
-int cur_process_bindid;
 bool suppress_listen_message;
 
 mdl_assoc_table_t *mdl_assoc_table;
@@ -58,14 +62,102 @@ mdl_value_t *mdl_value_atom_lastprog;
 mdl_value_t *mdl_value_atom_lastmap;
 mdl_value_t *mdl_value_atom_default;
 mdl_value_t *mdl_value_T;
+mdl_value_t *mdl_value_atom_lval;
+mdl_value_t *mdl_value_atom_gval;
+mdl_value_t *mdl_value_atom_quote;
+mdl_value_t *mdl_value_atom_comment;
+mdl_value_t *mdl_value_atom_toplevel;
+mdl_value_t *mdl_value_atom_inchan;
+mdl_value_t *mdl_value_atom_outchan;
+mdl_value_t *mdl_value_atom_parse_string;
+mdl_value_t *mdl_value_atom_parse_table;
+mdl_value_t *mdl_value_atom_read_table;
+mdl_value_t *mdl_value_atom_last_out;
+mdl_value_t *mdl_value_atom_close;
+mdl_value_t *mdl_value_atom_read;
+mdl_value_t *mdl_value_atom_terpri;
+mdl_value_t *mdl_value_atom_print;
+mdl_value_t *mdl_value_atom_any;
+mdl_value_t *mdl_value_atom_structured;
+mdl_value_t *mdl_value_atom_locative;
+mdl_value_t *mdl_value_atom_applicable;
+mdl_value_t *mdl_value_atom_decl;
+mdl_value_t *mdl_value_atom_primtype;
+mdl_value_t *mdl_value_atom_or;
+mdl_value_t *mdl_value_atom_rest;
+mdl_value_t *mdl_value_atom_opt;
+mdl_value_t *mdl_value_atom_l_level;
+mdl_value_t *mdl_value_atom_l_err;
+mdl_value_t *mdl_value_atom_int_level;
 mdl_value_t mdl_value_false = { PRIMTYPE_LIST, MDL_TYPE_FALSE};
 mdl_value_t mdl_value_unassigned = { PRIMTYPE_WORD, MDL_TYPE_UNBOUND};
 mdl_value_t *mdl_static_block_stack = nullptr;
 
 #define MDL_OBLIST_HASHBUCKET_DEFAULT 17
 #define MDL_ROOT_OBLIST_HASHBUCKET_DEFAULT 103
+// an oblist is rehashed when a bucket gets this long and it has more
+// than MDL_OBLIST_MAX_LOAD atoms per bucket
+#define MDL_OBLIST_MAX_CHAIN 8
+#define MDL_OBLIST_MAX_LOAD 2
+// atoms found on one .OBLIST path are remembered, see mdl_path_atom
+#define MDL_PATH_CACHE_SIZE 2048
+#define MDL_PATH_CACHE_MAX_OBLISTS 8
+
+// Atoms the interpreter refers to by name, found once by
+// mdl_find_known_atoms instead of on every use
+struct mdl_known_atom_t
+{
+    mdl_value_t **atom;
+    const char *pname;
+    bool interrupts; // on INTERRUPTS rather than ROOT
+};
+
+static const mdl_known_atom_t mdl_known_atoms[] =
+{
+    { &mdl_value_T, "T", false },
+    { &mdl_value_atom_redefine, "REDEFINE", false },
+    { &mdl_value_atom_default, "DEFAULT", false },
+    { &mdl_value_atom_lval, "LVAL", false },
+    { &mdl_value_atom_gval, "GVAL", false },
+    { &mdl_value_atom_quote, "QUOTE", false },
+    { &mdl_value_atom_comment, "COMMENT", false },
+    { &mdl_value_atom_toplevel, "TOPLEVEL", false },
+    { &mdl_value_atom_inchan, "INCHAN", false },
+    { &mdl_value_atom_outchan, "OUTCHAN", false },
+    { &mdl_value_atom_parse_string, "PARSE-STRING", false },
+    { &mdl_value_atom_parse_table, "PARSE-TABLE", false },
+    { &mdl_value_atom_read_table, "READ-TABLE", false },
+    { &mdl_value_atom_last_out, "LAST-OUT", false },
+    { &mdl_value_atom_close, "CLOSE", false },
+    { &mdl_value_atom_read, "READ", false },
+    { &mdl_value_atom_terpri, "TERPRI", false },
+    { &mdl_value_atom_print, "PRINT", false },
+    // for DECL checking
+    { &mdl_value_atom_any, "ANY", false },
+    { &mdl_value_atom_structured, "STRUCTURED", false },
+    { &mdl_value_atom_locative, "LOCATIVE", false },
+    { &mdl_value_atom_applicable, "APPLICABLE", false },
+    { &mdl_value_atom_decl, "DECL", false },
+    { &mdl_value_atom_primtype, "PRIMTYPE", false },
+    { &mdl_value_atom_or, "OR", false },
+    { &mdl_value_atom_rest, "REST", false },
+    { &mdl_value_atom_opt, "OPT", false },
+    { &mdl_value_atom_lastprog, "LPROG ", true },
+    { &mdl_value_atom_lastmap, "LMAP ", true },
+    { &mdl_value_atom_l_level, "L-LEVEL ", true },
+    { &mdl_value_atom_l_err, "L-ERR ", true },
+    { &mdl_value_atom_int_level, "INT-LEVEL", true },
+};
 
-#define NEW_BINDID(X) ((++(X))?(X):(++(X))) // increment bindid, but disallow 0
+// at startup, and after RESTORE with the restored oblists
+void mdl_find_known_atoms(mdl_value_t *root_oblist, mdl_value_t *interrupts_oblist)
+{
+    for (const mdl_known_atom_t &known : mdl_known_atoms)
+    {
+        *known.atom = mdl_get_or_create_atom_on_oblist(known.pname,
+            known.interrupts ? interrupts_oblist : root_oblist);
+    }
+}
 
 mdl_type_table_entry_t *mdl_type_table_entry(int typenum)
 {
@@ -123,9 +215,54 @@ mdl_value_t *mdl_internal_newtype(mdl_value_t *a, int oldtype)
     newt.a = a->v.a;
     newt.a->typenum = mdl_type_table.size();
     mdl_type_table.push_back(newt);
+    mdl_update_type_flags(newt.a->typenum);
     return a;
 }
 
+std::vector<unsigned char> mdl_type_flags;
+
+void mdl_update_type_flags(int typenum)
+{
+    const mdl_type_table_entry_t *tte = mdl_type_table_entry(typenum);
+    if (!tte)
+    {
+        return;
+    }
+    if ((size_t)typenum >= mdl_type_flags.size())
+    {
+        mdl_type_flags.resize(mdl_type_table.size());
+    }
+
+    unsigned char flags = 0;
+    if (tte->evaltype) flags |= MDL_TYPE_FLAG_EVALTYPE;
+    if (tte->applytype) flags |= MDL_TYPE_FLAG_APPLYTYPE;
+    if (tte->printtype) flags |= MDL_TYPE_FLAG_PRINTTYPE;
+    if (mdl_primtype_structured(tte->pt)) flags |= MDL_TYPE_FLAG_STRUCTURED;
+    switch (typenum)
+    {
+    case MDL_TYPE_LIST:
+    case MDL_TYPE_SEGMENT:
+    case MDL_TYPE_FORM:
+    case MDL_TYPE_VECTOR:
+    case MDL_TYPE_UVECTOR:
+        break;
+    default:
+        // see the default case of mdl_std_eval
+        if (!tte->evaltype) flags |= MDL_TYPE_FLAG_SELF_EVAL;
+        break;
+    }
+    mdl_type_flags[typenum] = flags;
+}
+
+void mdl_rebuild_type_flags()
+{
+    mdl_type_flags.assign(mdl_type_table.size(), 0);
+    for (size_t i = 0; i < mdl_type_table.size(); i++)
+    {
+        mdl_update_type_flags(i);
+    }
+}
+
 mdl_value_t *mdl_get_printtype(int typenum)
 {
     const mdl_type_table_entry_t *tte = mdl_type_table_entry(typenum);
@@ -150,6 +287,7 @@ mdl_value_t *mdl_set_printtype(int typenum, mdl_value_t *how)
     if (tte)
     {
         tte->printtype = how;
+        mdl_update_type_flags(typenum);
         return how;
     }
     return nullptr;
@@ -161,6 +299,8 @@ mdl_value_t *mdl_set_evaltype(int typenum, mdl_value_t *how)
     if (tte)
     {
         tte->evaltype = how;
+        mdl_update_type_flags(typenum);
+        mdl_invalidate_code();
         return how;
     }
     return nullptr;
@@ -172,6 +312,8 @@ mdl_value_t *mdl_set_applytype(int typenum, mdl_value_t *how)
     if (tte)
     {
         tte->applytype = how;
+        mdl_update_type_flags(typenum);
+        mdl_invalidate_code();
         return how;
     }
     return nullptr;
@@ -321,6 +463,7 @@ bool mdl_value_equal(const mdl_value_t *a, const mdl_value_t *b)
     {
         return true;
     }
+    mdl_check_stack();
     if (!a || !b)
     {
         return false;
@@ -441,13 +584,20 @@ MDL_INT mdl_hash_pname(const char *pname)
 }
 
 mdl_value_t *mdl_get_atom_from_oblist(const char *pname, mdl_value_t *oblist)
+{
+    return mdl_get_atom_from_oblist(pname, mdl_hash_pname(pname), oblist);
+}
+
+// hash is mdl_hash_pname(pname), for callers looking in several oblists
+// or with an atom in hand
+mdl_value_t *mdl_get_atom_from_oblist(const char *pname, MDL_INT hash, mdl_value_t *oblist)
 {
     if (oblist->type != MDL_TYPE_OBLIST)
     {
         mdl_error("Oblist not of oblist type in atom lookup");
     }
     int buckets = UVLENGTH(oblist);
-    MDL_INT bucket_num = mdl_hash_pname(pname) % buckets;
+    MDL_INT bucket_num = hash % buckets;
 
     uvector_element_t *bucket = mdl_internal_uvector_rest(oblist, bucket_num);
 
@@ -459,7 +609,7 @@ mdl_value_t *mdl_get_atom_from_oblist(const char *pname, mdl_value_t *oblist)
         {
             mdl_error("Something not an atom in the oblist");
         }
-        if (!std::strcmp(pname, av->v.a->pname))
+        if (av->v.a->hash == hash && !std::strcmp(pname, av->v.a->pname))
         {
             return av;
         }
@@ -468,14 +618,82 @@ mdl_value_t *mdl_get_atom_from_oblist(const char *pname, mdl_value_t *oblist)
     return nullptr;
 }
 
-mdl_value_t *mdl_remove_atom_from_oblist(const char *pname, mdl_value_t *oblist)
+// Atoms found by searching an .OBLIST path, so READ and PRINT don't
+// probe every oblist on the path for each atom.  Only one path is
+// cached, the last one searched; it is recognized by its elements, so
+// changing the LIST empties the cache.  INSERT and REMOVE forget the
+// pname they change, which is all that can make an entry wrong, but
+// MDL code that changes the buckets itself isn't noticed
+struct mdl_path_cache_t
+{
+    int noblists;
+    mdl_value_t *oblists[MDL_PATH_CACHE_MAX_OBLISTS];
+    mdl_value_t *atoms[MDL_PATH_CACHE_SIZE];
+};
+
+static mdl_path_cache_t mdl_path_cache;
+
+// The cache is two-way: an atom goes in the pair of entries its hash
+// picks, the most recently found first.  This returns the pair for
+// hash if the cache holds path, else nullptr
+static mdl_value_t **mdl_path_cache_pair(mdl_value_t *path, MDL_INT hash)
+{
+    mdl_value_t *cursor = path->v.p.cdr;
+    int n = 0;
+    while (cursor && n < mdl_path_cache.noblists && mdl_path_cache.oblists[n] == cursor->v.p.car)
+    {
+        cursor = cursor->v.p.cdr;
+        n++;
+    }
+    if (cursor || n != mdl_path_cache.noblists)
+    {
+        // a different path; start over with this one
+        n = 0;
+        for (cursor = path->v.p.cdr; cursor; cursor = cursor->v.p.cdr)
+        {
+            if (n == MDL_PATH_CACHE_MAX_OBLISTS)
+            {
+                mdl_path_cache.noblists = -1; // too long to cache
+                return nullptr;
+            }
+            mdl_path_cache.oblists[n++] = cursor->v.p.car;
+        }
+        mdl_path_cache.noblists = n;
+        std::fill(mdl_path_cache.atoms, mdl_path_cache.atoms + MDL_PATH_CACHE_SIZE, nullptr);
+    }
+    return &mdl_path_cache.atoms[hash & (MDL_PATH_CACHE_SIZE - 2)];
+}
+
+// the entry of pair holding pname, or nullptr
+static mdl_value_t **mdl_path_cache_entry(mdl_value_t **pair, const char *pname, MDL_INT hash)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        if (pair[i] && pair[i]->v.a->hash == hash && !std::strcmp(pname, pair[i]->v.a->pname))
+        {
+            return &pair[i];
+        }
+    }
+    return nullptr;
+}
+
+static void mdl_path_cache_forget(const char *pname, MDL_INT hash)
+{
+    mdl_value_t **entry = mdl_path_cache_entry(&mdl_path_cache.atoms[hash & (MDL_PATH_CACHE_SIZE - 2)], pname, hash);
+    if (entry)
+    {
+        *entry = nullptr;
+    }
+}
+
+mdl_value_t *mdl_remove_atom_from_oblist(const char *pname, MDL_INT hash, mdl_value_t *oblist)
 {
     if (oblist->type != MDL_TYPE_OBLIST)
     {
         mdl_error("Oblist not of oblist type in atom remove");
     }
     int buckets = UVLENGTH(oblist);
-    MDL_INT bucket_num = mdl_hash_pname(pname) % buckets;
+    MDL_INT bucket_num = hash % buckets;
 
     uvector_element_t *bucket = mdl_internal_uvector_rest(oblist, bucket_num);
 
@@ -488,7 +706,7 @@ mdl_value_t *mdl_remove_atom_from_oblist(const char *pname, mdl_value_t *oblist)
         {
             mdl_error("Something not an atom in the oblist");
         }
-        if (!std::strcmp(pname, av->v.a->pname))
+        if (av->v.a->hash == hash && !std::strcmp(pname, av->v.a->pname))
         {
             if (cursor == bucket->l)
             {
@@ -499,6 +717,11 @@ mdl_value_t *mdl_remove_atom_from_oblist(const char *pname, mdl_value_t *oblist)
                 lastcursor->v.p.cdr = cursor->v.p.cdr;
             }
             av->v.a->oblist = nullptr;
+            mdl_path_cache_forget(pname, hash);
+            if (mdl_assoc_table)
+            {
+                mdl_assoc_atom_removed(mdl_assoc_table, av->v.a);
+            }
             return av;
         }
         lastcursor = cursor;
@@ -507,25 +730,82 @@ mdl_value_t *mdl_remove_atom_from_oblist(const char *pname, mdl_value_t *oblist)
     return nullptr;
 }
 
+// Oblists don't keep a count of their atoms, since MDL code can change
+// the buckets behind our backs; a long bucket is the cue to count them.
+// The bucket vector is replaced in the block, so every reference to
+// the oblist sees the new one
+static void mdl_grow_oblist(mdl_value_t *oblist)
+{
+    mdl_uvector_block_t *block = oblist->v.uv.p;
+    if (oblist->v.uv.offset || block->startoffset)
+    {
+        return;
+    }
+    int buckets = block->size;
+    int population = 0;
+    for (int i = 0; i < buckets; i++)
+    {
+        for (mdl_value_t *cursor = block->elements[i].l; cursor; cursor = cursor->v.p.cdr)
+        {
+            if (cursor->v.p.car->type != MDL_TYPE_ATOM)
+            {
+                return;
+            }
+            population++;
+        }
+    }
+    if (population <= buckets * MDL_OBLIST_MAX_LOAD || population >= INT_MAX / 2)
+    {
+        return;
+    }
+
+    int new_buckets = population | 1;
+    uvector_element_t *elems = (uvector_element_t *)GC_MALLOC_IGNORE_OFF_PAGE(new_buckets * sizeof(uvector_element_t));
+    for (int i = 0; i < buckets; i++)
+    {
+        mdl_value_t *cursor = block->elements[i].l;
+        while (cursor)
+        {
+            mdl_value_t *next = cursor->v.p.cdr;
+            MDL_INT bucket_num = cursor->v.p.car->v.a->hash % new_buckets;
+            cursor->v.p.cdr = elems[bucket_num].l;
+            elems[bucket_num].l = cursor;
+            cursor = next;
+        }
+    }
+    block->elements = elems;
+    block->size = new_buckets;
+}
+
 // note that it is assumed the atom isn't already there
-void mdl_put_atom_in_oblist(const char *pname, mdl_value_t *oblist, mdl_value_t *new_atom)
+void mdl_put_atom_in_oblist(mdl_value_t *oblist, mdl_value_t *new_atom)
 {
     if (oblist->type != MDL_TYPE_OBLIST)
     {
         mdl_error("Oblist not of oblist type in atom lookup");
     }
     int buckets = UVLENGTH(oblist);
-    MDL_INT bucket_num = mdl_hash_pname(pname) % buckets;
+    MDL_INT bucket_num = new_atom->v.a->hash % buckets;
 
     uvector_element_t *bucket = mdl_internal_uvector_rest(oblist, bucket_num);
     mdl_value_t *n = mdl_newlist();
     n->v.p.car = new_atom;
     n->v.p.cdr = bucket->l;
     bucket->l = n;
+    mdl_path_cache_forget(new_atom->v.a->pname, new_atom->v.a->hash);
+
+    int chain = 0;
+    for (mdl_value_t *cursor = n; cursor && chain <= MDL_OBLIST_MAX_CHAIN; cursor = cursor->v.p.cdr)
+    {
+        chain++;
+    }
+    if (chain > MDL_OBLIST_MAX_CHAIN)
+    {
+        mdl_grow_oblist(oblist);
+    }
 }
 
-// create an atom not on an oblist
-mdl_value_t *mdl_create_atom(const char *pname)
+static mdl_value_t *mdl_create_atom(const char *pname, MDL_INT hash)
 {
 //    atom_t *a = (atom_t *)GC_MALLOC(sizeof(atom_t) + std::strlen(pname)); // the -1 and +1 cancel
 //    std::strcpy(a->pname, pname);
@@ -534,10 +814,17 @@ mdl_value_t *mdl_create_atom(const char *pname)
     a->typenum = MDL_TYPE_NOTATYPE;
     a->pname = mdl_new_raw_string(len, true);
     std::strcpy(a->pname, pname);
+    a->hash = hash;
     mdl_value_t *atomval = mdl_newatomval(a);
     return atomval;
 }
 
+// create an atom not on an oblist
+mdl_value_t *mdl_create_atom(const char *pname)
+{
+    return mdl_create_atom(pname, mdl_hash_pname(pname));
+}
+
 mdl_value_t *mdl_create_atom_on_oblist(const char *pname, mdl_value_t *oblist)
 {
     if (oblist->type != MDL_TYPE_OBLIST)
@@ -545,14 +832,15 @@ mdl_value_t *mdl_create_atom_on_oblist(const char *pname, mdl_value_t *oblist)
         mdl_error("Oblist not of oblist type in ATOM create");
     }
 
-    if (mdl_get_atom_from_oblist(pname, oblist))
+    MDL_INT hash = mdl_hash_pname(pname);
+    if (mdl_get_atom_from_oblist(pname, hash, oblist))
     {
         return nullptr; // no dupes allowed
     }
 
-    mdl_value_t *atomval = mdl_create_atom(pname);
+    mdl_value_t *atomval = mdl_create_atom(pname, hash);
     atomval->v.a->oblist = oblist;
-    mdl_put_atom_in_oblist(pname, oblist, atomval);
+    mdl_put_atom_in_oblist(oblist, atomval);
     return atomval;
 }
 
@@ -564,14 +852,15 @@ mdl_value_t *mdl_get_or_create_atom_on_oblist(const char *pname, mdl_value_t *ob
     }
 
     mdl_value_t *atomval;
-    if ((atomval = mdl_get_atom_from_oblist(pname, oblist)))
+    MDL_INT hash = mdl_hash_pname(pname);
+    if ((atomval = mdl_get_atom_from_oblist(pname, hash, oblist)))
     {
         return atomval;
     }
 
-    atomval = mdl_create_atom(pname);
+    atomval = mdl_create_atom(pname, hash);
     atomval->v.a->oblist = oblist;
-    mdl_put_atom_in_oblist(pname, oblist, atomval);
+    mdl_put_atom_in_oblist(oblist, atomval);
     return atomval;
 }
 
@@ -645,6 +934,14 @@ mdl_value_t *mdl_get_atom_default_oblist(const char *pname, bool insert_allowed,
     }
     else if (oblists->type == MDL_TYPE_LIST)
     {
+        MDL_INT hash = mdl_hash_pname(pname);
+        mdl_value_t **pair = mdl_path_cache_pair(oblists, hash);
+        mdl_value_t **entry = pair ? mdl_path_cache_entry(pair, pname, hash) : nullptr;
+        if (entry)
+        {
+            return *entry;
+        }
+
         mdl_value_t *cursor = oblists->v.p.cdr;
         mdl_value_t *default_marker = oblists;
         while (cursor && !a)
@@ -652,7 +949,7 @@ mdl_value_t *mdl_get_atom_default_oblist(const char *pname, bool insert_allowed,
             mdl_value_t *oblist = cursor->v.p.car;
             if (oblist->type == MDL_TYPE_OBLIST)
             {
-                a = mdl_get_atom_from_oblist(pname, oblist);
+                a = mdl_get_atom_from_oblist(pname, hash, oblist);
             }
             else if (insert_allowed && mdl_value_equal(oblist, mdl_value_atom_default))
             {
@@ -678,6 +975,11 @@ mdl_value_t *mdl_get_atom_default_oblist(const char *pname, bool insert_allowed,
             }
             a = mdl_create_atom_on_oblist(pname, default_marker);
         }
+        if (pair && a)
+        {
+            pair[1] = pair[0];
+            pair[0] = a;
+        }
     }
     return a;
 }
@@ -839,8 +1141,65 @@ mdl_value_t *mdl_new_string(const char *s)
     return mdl_new_string(std::strlen(s), s);
 }
 
+// Small FIXes and every CHARACTER are preallocated, and mdl_new_word
+// hands those out instead of allocating.  They are shared, so a value
+// from mdl_new_word must be copied, not modified, to change it.
+//
+// The next step is tagged immediates: GC_MALLOC returns 8-byte aligned
+// memory, so an mdl_value_t * with its low bit set could carry a FIX
+// (value << 3) or CHARACTER in the pointer itself, with no table at
+// all.  That needs every ->type, ->pt and ->v.w on a value pointer to
+// go through accessor macros that check the tag, and a deref at the
+// places that copy values into structures (*tail = *newitem and the
+// like).  FIXes too wide for the pointer stay boxed.  The collector
+// ignores such pointers, and SAVE writes values, not pointers, so
+// neither needs changing.
+#define MDL_SMALL_FIX_MIN -256
+#define MDL_SMALL_FIX_MAX 1023
+#define MDL_CHARACTER_MIN -128 // strings are char *, which may be signed
+#define MDL_CHARACTER_MAX 255
+// The tables are in the collector's heap, though never collected.  A
+// value is an element of one, not the start of an object, so it can't
+// have a disappearing link; mdl_is_shared_word tells an association to
+// hold it instead
+static mdl_value_t *mdl_small_fixes;
+static mdl_value_t *mdl_characters;
+static bool mdl_small_words_ready = false;
+
+static void mdl_init_small_words()
+{
+    mdl_small_fixes = (mdl_value_t *)GC_MALLOC_UNCOLLECTABLE(sizeof(mdl_value_t) * (MDL_SMALL_FIX_MAX - MDL_SMALL_FIX_MIN + 1));
+    mdl_characters = (mdl_value_t *)GC_MALLOC_UNCOLLECTABLE(sizeof(mdl_value_t) * (MDL_CHARACTER_MAX - MDL_CHARACTER_MIN + 1));
+    for (int i = MDL_SMALL_FIX_MIN; i <= MDL_SMALL_FIX_MAX; i++)
+    {
+        mdl_value_t *v = &mdl_small_fixes[i - MDL_SMALL_FIX_MIN];
+        v->pt = PRIMTYPE_WORD;
+        v->type = MDL_TYPE_FIX;
+        v->v.w = i;
+    }
+    for (int i = MDL_CHARACTER_MIN; i <= MDL_CHARACTER_MAX; i++)
+    {
+        mdl_value_t *v = &mdl_characters[i - MDL_CHARACTER_MIN];
+        v->pt = PRIMTYPE_WORD;
+        v->type = MDL_TYPE_CHARACTER;
+        v->v.w = i;
+    }
+    mdl_small_words_ready = true;
+}
+
 mdl_value_t *mdl_new_word(MDL_INT fix, int type)
 {
+    if (mdl_small_words_ready)
+    {
+        if (type == MDL_TYPE_FIX && fix >= MDL_SMALL_FIX_MIN && fix <= MDL_SMALL_FIX_MAX)
+        {
+            return &mdl_small_fixes[fix - MDL_SMALL_FIX_MIN];
+        }
+        if (type == MDL_TYPE_CHARACTER && fix >= MDL_CHARACTER_MIN && fix <= MDL_CHARACTER_MAX)
+        {
+            return &mdl_characters[fix - MDL_CHARACTER_MIN];
+        }
+    }
     mdl_value_t *result = mdl_new_mdl_value();
     result->pt = PRIMTYPE_WORD;
     result->type = type;
@@ -848,6 +1207,14 @@ mdl_value_t *mdl_new_word(MDL_INT fix, int type)
     return result;
 }
 
+// a value mdl_new_word hands out to everyone, which is never collected
+bool mdl_is_shared_word(const mdl_value_t *v)
+{
+    return mdl_small_words_ready &&
+        ((v >= mdl_small_fixes && v < mdl_small_fixes + (MDL_SMALL_FIX_MAX - MDL_SMALL_FIX_MIN + 1)) ||
+         (v >= mdl_characters && v < mdl_characters + (MDL_CHARACTER_MAX - MDL_CHARACTER_MIN + 1)));
+}
+
 mdl_value_t *mdl_new_float(MDL_FLOAT flt)
 {
     mdl_value_t *result = mdl_new_mdl_value();
@@ -1660,7 +2027,7 @@ mdl_value_t *mdl_make_localvar_ref(mdl_value_t *a, int reftype)
     mdl_value_t *r = mdl_newlist();
     r->v.p.cdr = mdl_newlist();
     r->v.p.cdr->v.p.car = a;
-    r->v.p.car = mdl_get_atom_from_oblist("LVAL", mdl_value_root_oblist);
+    r->v.p.car = mdl_value_atom_lval;
     return mdl_make_list(r, reftype);
 }
 
@@ -1669,7 +2036,7 @@ mdl_value_t *mdl_make_globalvar_ref(mdl_value_t *a, int reftype)
     mdl_value_t *r = mdl_newlist();
     r->v.p.cdr = mdl_newlist();
     r->v.p.cdr->v.p.car = a;
-    r->v.p.car = mdl_get_atom_from_oblist("GVAL", mdl_value_root_oblist);
+    r->v.p.car = mdl_value_atom_gval;
     return mdl_make_list(r, reftype);
 }
 
@@ -1678,20 +2045,142 @@ mdl_value_t *mdl_make_quote(mdl_value_t *a, int qtype)
     mdl_value_t *r = mdl_newlist();
     r->v.p.cdr = mdl_newlist();
     r->v.p.cdr->v.p.car = a;
-    r->v.p.car = mdl_get_atom_from_oblist("QUOTE", mdl_value_root_oblist);
+    r->v.p.car = mdl_value_atom_quote;
     return mdl_make_list(r, qtype);
 }
 
 mdl_frame_t *mdl_new_frame()
 {
-    mdl_frame_t *r = GC_NEW(mdl_frame_t);
     // GC_MALLOC does a clear, so no need to clear anything
-    r->syms = new(UseGC) mdl_local_symbol_table_t();
+    return GC_NEW(mdl_frame_t);
+}
+
+// SUBR, FSUBR, FUNCTION and BIND frames come from a free list.  A frame
+// goes back on the list when it is popped normally, unless a FRAME
+// value (or an ACTIVATION or ENVIRONMENT) has been made for it or for
+// a frame above it.  Frames skipped by a longjmp or a throw are simply
+// left to the collector, as are those past MDL_FREE_FRAMES_MAX, so a
+// long chain of tail calls doesn't leave its frames behind forever.
+#define MDL_FREE_FRAMES_MAX 1024
+static traceable_vector<mdl_frame_t *> mdl_free_frames;
+
+mdl_frame_t *mdl_new_pooled_frame()
+{
+    mdl_frame_t *r;
+    if (mdl_free_frames.empty())
+    {
+        r = GC_NEW(mdl_frame_t);
+    }
+    else
+    {
+        r = mdl_free_frames.back();
+        mdl_free_frames.pop_back();
+    }
+    r->frame_flags = MDL_FRAME_FLAGS_POOLED;
     return r;
 }
 
+void mdl_release_frame(mdl_frame_t *frame)
+{
+    if ((frame->frame_flags & (MDL_FRAME_FLAGS_POOLED | MDL_FRAME_FLAGS_CAPTURED)) != MDL_FRAME_FLAGS_POOLED ||
+        mdl_free_frames.size() >= MDL_FREE_FRAMES_MAX)
+    {
+        return;
+    }
+    frame->prev_frame = nullptr;
+    frame->result = nullptr;
+    mdl_clear_frame_bindings(frame);
+    frame->subr = nullptr;
+    frame->args = nullptr;
+    frame->frame_flags = 0;
+    frame->tail_code = nullptr;
+    frame->interp_frame = nullptr;
+    mdl_free_frames.push_back(frame);
+}
+
+// Evaluated SUBR arguments are consed from a stack of reusable cells
+// rather than from the heap.  The SUBR sees an ordinary list, but one
+// that is only good until it returns, so anything that keeps its
+// argument list (APPLY, MAPRET, MAPSTOP, a FRAME value) copies it with
+// mdl_argstack_copy_list.  Chunks are never moved, since argument lists
+// point into them.  The cells after the head are typed
+// MDL_TYPE_ARGSTACK_CELL, which nothing looks at, so they can be told
+// from heap cells without looking for their chunk; the head is seen by
+// the SUBR, so it stays a LIST.
+#define MDL_ARGSTACK_CHUNK 1024
+#define MDL_TYPE_ARGSTACK_CELL (MDL_TYPE_NOTATYPE - 1)
+static traceable_vector<mdl_value_t *> mdl_argstack_chunks;
+size_t mdl_argstack_top;
+
+mdl_value_t *mdl_argstack_cons(mdl_value_t *a, mdl_value_t *b)
+{
+    size_t chunk = mdl_argstack_top / MDL_ARGSTACK_CHUNK;
+    if (chunk == mdl_argstack_chunks.size())
+    {
+        mdl_argstack_chunks.push_back((mdl_value_t *)GC_MALLOC_IGNORE_OFF_PAGE(MDL_ARGSTACK_CHUNK * sizeof(mdl_value_t)));
+    }
+    mdl_value_t *nl = mdl_argstack_chunks[chunk] + (mdl_argstack_top++ % MDL_ARGSTACK_CHUNK);
+    nl->pt = PRIMTYPE_LIST;
+    nl->type = MDL_TYPE_ARGSTACK_CELL;
+    nl->v.p.car = a;
+    nl->v.p.cdr = b;
+    return nl;
+}
+
+mdl_value_t *mdl_argstack_make_list(mdl_value_t *l)
+{
+    mdl_value_t *r = mdl_argstack_cons(nullptr, l);
+    r->type = MDL_TYPE_LIST;
+    return r;
+}
+
+// only needed for the head of a list, see mdl_argstack_cons
+static bool mdl_argstack_owns(const mdl_value_t *cell)
+{
+    for (mdl_value_t *chunk : mdl_argstack_chunks)
+    {
+        if (cell >= chunk && cell < chunk + MDL_ARGSTACK_CHUNK)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// returns l if it isn't on the argument stack, otherwise a heap copy
+// of it.  Only the cells on the stack are copied; a tail shared with
+// a segment stays shared.
+mdl_value_t *mdl_argstack_copy_list(mdl_value_t *l)
+{
+    if (!l || !mdl_argstack_owns(l))
+    {
+        return l;
+    }
+    mdl_value_t *result = mdl_newlist();
+    *result = *l;
+    mdl_value_t *lastitem = result;
+    mdl_value_t *cursor = l->v.p.cdr;
+    while (cursor && cursor->type == MDL_TYPE_ARGSTACK_CELL)
+    {
+        lastitem->v.p.cdr = mdl_cons_internal(cursor->v.p.car, nullptr);
+        lastitem = lastitem->v.p.cdr;
+        cursor = cursor->v.p.cdr;
+    }
+    lastitem->v.p.cdr = cursor;
+    return result;
+}
+
 mdl_value_t *mdl_make_frame_value(mdl_frame_t *frame, int t = MDL_TYPE_FRAME)
 {
+    // the frame and everything under it may now be looked at after
+    // they return, so none of them can be reused, and their arguments
+    // must be off the argument stack
+    for (mdl_frame_t *f = frame; f && !(f->frame_flags & MDL_FRAME_FLAGS_CAPTURED); f = f->prev_frame)
+    {
+        f->frame_flags |= MDL_FRAME_FLAGS_CAPTURED;
+        f->args = mdl_argstack_copy_list(f->args);
+    }
+
     mdl_value_t *result = mdl_new_mdl_value();
     result->pt = PRIMTYPE_FRAME;
     result->type = t;
@@ -1699,10 +2188,193 @@ mdl_value_t *mdl_make_frame_value(mdl_frame_t *frame, int t = MDL_TYPE_FRAME)
     return result;
 }
 
+// Runaway recursion is a CONTROL-STACK-OVERFLOW error rather than a
+// crash.  Pushing a frame checks both the frame depth (less frames
+// kept only for tail calls, see mdl_apply_function), which is
+// unlimited unless set with -d, and the C stack left, which must cover
+// MDL_STACK_RESERVE; EVAL, PRINT and =? of deeply nested structures
+// check the C stack too (mdl_check_stack).  The LISTEN started for the error may go
+// MDL_OVERFLOW_GRACE_FRAMES deeper and use most of the reserve; past
+// that, or if it overflows again, it's back to toplevel.
+#define MDL_OVERFLOW_GRACE_FRAMES 1000
+#define MDL_STACK_RESERVE (512 * 1024)
+#define MDL_STACK_HARD_RESERVE (64 * 1024)
+#define MDL_STACK_DEFAULT_SIZE (8 * 1024 * 1024)
+static unsigned mdl_frame_depth_limit = UINT_MAX;
+static unsigned mdl_frame_depth_hard_limit = UINT_MAX;
+uintptr_t mdl_stack_limit;
+static uintptr_t mdl_stack_hard_limit;
+// the frame current when the error was raised, until it is popped
+static mdl_frame_t *mdl_overflow_frame;
+
+static void mdl_init_stack_limits()
+{
+    uintptr_t base = (uintptr_t)__builtin_frame_address(0);
+    size_t size = MDL_STACK_DEFAULT_SIZE;
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_STACK, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY)
+    {
+        size = rl.rlim_cur;
+    }
+    size_t reserve = std::min<size_t>(MDL_STACK_RESERVE, size / 4);
+    size_t hard_reserve = std::min<size_t>(MDL_STACK_HARD_RESERVE, size / 16);
+    mdl_stack_limit = base - (size - reserve);
+    mdl_stack_hard_limit = base - (size - hard_reserve);
+}
+
+// whether FLOAD keeps the comments in the files it reads, for GETPROP
+static bool mdl_fload_keeps_comments = false;
+
+void mdl_set_fload_comments(bool keep)
+{
+    mdl_fload_keeps_comments = keep;
+}
+
+// 0 for no limit
+void mdl_set_max_frame_depth(unsigned depth)
+{
+    if (depth == 0 || depth > UINT_MAX - MDL_OVERFLOW_GRACE_FRAMES)
+    {
+        mdl_frame_depth_limit = mdl_frame_depth_hard_limit = UINT_MAX;
+    }
+    else
+    {
+        mdl_frame_depth_limit = depth;
+        mdl_frame_depth_hard_limit = depth + MDL_OVERFLOW_GRACE_FRAMES;
+    }
+}
+
+static void mdl_stack_overflow(mdl_frame_t *frame, uintptr_t sp)
+{
+    if (!mdl_overflow_frame)
+    {
+        mdl_overflow_frame = cur_frame;
+        // ERRET from here carries on, with what's left
+        mdl_call_error("CONTROL-STACK-OVERFLOW", nullptr);
+    }
+    else if (frame->depth - frame->kept > mdl_frame_depth_hard_limit || sp < mdl_stack_hard_limit)
+    {
+        mdl_error("Stack overflow handling CONTROL-STACK-OVERFLOW");
+    }
+}
+
+void mdl_stack_overflow(uintptr_t sp)
+{
+    mdl_stack_overflow(cur_frame, sp);
+}
+
+// Locals are shallow bound.  Each atom points at its innermost binding,
+// and each binding at the one it shadows, for every frame from
+// mdl_bound_frame down; those frames are flagged
+// MDL_FRAME_FLAGS_BOUND.  mdl_bound_frame follows cur_frame as frames
+// are pushed and popped (including by mdl_longjmp_to), so LVAL and SET
+// from cur_frame don't search.  When cur_frame is set directly (EVAL in
+// an environment, errors to toplevel) the bindings are moved over the
+// next time they are needed.  Lookups from any other frame search the
+// frames as before.
+static mdl_frame_t *mdl_bound_frame;
+
+static inline void mdl_install_binding(mdl_local_symbol_t *sym)
+{
+    sym->prev_binding = sym->atom->binding;
+    sym->atom->binding = sym;
+}
+
+static void mdl_bind_frame(mdl_frame_t *frame)
+{
+    for (int i = 0; i < frame->nsyms; i++)
+    {
+        mdl_install_binding(&frame->inline_syms[i]);
+    }
+    if (frame->syms)
+    {
+        for (auto &elem : *frame->syms)
+        {
+            mdl_install_binding(&elem.second);
+        }
+    }
+    frame->frame_flags |= MDL_FRAME_FLAGS_BOUND;
+}
+
+static void mdl_unbind_frame(mdl_frame_t *frame)
+{
+    for (int i = 0; i < frame->nsyms; i++)
+    {
+        frame->inline_syms[i].atom->binding = frame->inline_syms[i].prev_binding;
+    }
+    if (frame->syms)
+    {
+        for (auto &elem : *frame->syms)
+        {
+            elem.second.atom->binding = elem.second.prev_binding;
+        }
+    }
+    frame->frame_flags &= ~MDL_FRAME_FLAGS_BOUND;
+}
+
+// make the atoms' bindings the ones seen from frame
+static void mdl_rebind_frames(mdl_frame_t *frame)
+{
+    static std::vector<mdl_frame_t *> to_bind;
+    mdl_frame_t *from = mdl_bound_frame;
+    mdl_frame_t *to = frame;
+
+    while (from && (!to || from->depth > to->depth))
+    {
+        mdl_unbind_frame(from);
+        from = from->prev_frame;
+    }
+    while (to && (!from || to->depth > from->depth))
+    {
+        to_bind.push_back(to);
+        to = to->prev_frame;
+    }
+    while (from != to && from && to)
+    {
+        mdl_unbind_frame(from);
+        from = from->prev_frame;
+        to_bind.push_back(to);
+        to = to->prev_frame;
+    }
+    while (!to_bind.empty())
+    {
+        mdl_bind_frame(to_bind.back());
+        to_bind.pop_back();
+    }
+    mdl_bound_frame = frame;
+}
+
+// for RESTORE, which replaces the top level bindings
+void mdl_unbind_all_frames()
+{
+    mdl_rebind_frames(nullptr);
+}
+
+void mdl_clear_frame_bindings(mdl_frame_t *frame)
+{
+    frame->nsyms = 0;
+    std::memset(frame->inline_syms, 0, sizeof(frame->inline_syms));
+    frame->syms = nullptr;
+}
+
 inline mdl_frame_t *mdl_push_frame(mdl_frame_t *frame)
 {
+    uintptr_t sp = (uintptr_t)__builtin_frame_address(0);
+    frame->depth = cur_frame ? cur_frame->depth + 1 : 0;
+    frame->kept = cur_frame ? cur_frame->kept : 0;
+    if (frame->depth - frame->kept > mdl_frame_depth_limit || sp < mdl_stack_limit)
+    {
+        mdl_stack_overflow(frame, sp);
+    }
+    if (cur_frame != mdl_bound_frame)
+    {
+        mdl_rebind_frames(cur_frame);
+    }
     frame->prev_frame = cur_frame;
     cur_frame = frame;
+    // the frame may already have bindings, like its activation
+    mdl_bind_frame(frame);
+    mdl_bound_frame = frame;
     return frame->prev_frame;
 }
 
@@ -1712,17 +2384,17 @@ mdl_frame_t *mdl_pop_frame(mdl_frame_t *frame)
     {
         mdl_error("Frames confused");
     }
-#ifdef CACHE_LOCAL_SYMBOLS
-    for (auto iter = cur_frame->syms->begin(); iter != cur_frame->syms->end(); iter++)
+    if (cur_frame != mdl_bound_frame)
     {
-        if ((iter->second.atom->bindid == cur_process_bindid) &&
-            (iter->second.atom->binding == &iter->second))
-        {
-            iter->second.atom->binding = iter->second.prev_binding;
-        }
+        mdl_rebind_frames(cur_frame);
     }
-#endif
+    mdl_unbind_frame(cur_frame);
+    mdl_bound_frame = frame;
 
+    if (cur_frame == mdl_overflow_frame)
+    {
+        mdl_overflow_frame = nullptr;
+    }
     cur_frame = frame;
     return cur_frame;
 }
@@ -1749,19 +2421,27 @@ void mdl_longjmp_to(mdl_frame_t *jump_frame, int value)
     {
         mdl_error("Tried to jump to frame not on stack!");
     }
-    mdl_longjmp(cur_frame->interp_frame, value);
+    if (frame->frame_flags & MDL_FRAME_FLAGS_CATCH)
+    {
+        throw mdl_frame_jump_t{frame, value};
+    }
+    if (!frame->interp_frame)
+    {
+        mdl_error("Tried to jump to frame with no jump target!");
+    }
+    mdl_longjmp(*frame->interp_frame, value);
 }
 
 void mdl_error(const char *err)
 {
     std::fflush(stdout);
     std::fprintf(stderr, "%s\n",err);
-    if (initial_frame)
+    mdl_overflow_frame = nullptr;
+    if (initial_frame && initial_frame->interp_frame)
     {
 //        std::fprintf(stderr, "Error to initial jumpbuf\n");
         cur_frame = initial_frame;
-        NEW_BINDID(cur_process_bindid);
-        mdl_longjmp(initial_frame->interp_frame, LONGJMP_ERROR);
+        mdl_longjmp(*initial_frame->interp_frame, LONGJMP_ERROR);
     }
     std::fprintf(stderr, "Fatal: Lost my stack\n");
     std::exit(-1);
@@ -1818,22 +2498,45 @@ mdl_value_t *mdl_parse_string(mdl_value_t *str, int radix, mdl_value_t *lookahea
 
 mdl_value_t *mdl_global_symbol_lookup(const atom_t *atom)
 {
-    auto iter = global_syms.find(atom);
-    if (iter == global_syms.end())
+    mdl_global_reads++;
+    return atom->global ? atom->global->binding : nullptr;
+}
+
+// the binding of atom in frame itself
+static mdl_local_symbol_t *mdl_frame_binding(mdl_frame_t *frame, const atom_t *atom)
+{
+    for (int i = 0; i < frame->nsyms; i++)
     {
-        return nullptr;
+        if (frame->inline_syms[i].atom == atom)
+        {
+            return &frame->inline_syms[i];
+        }
+    }
+    if (frame->syms)
+    {
+        auto iter = frame->syms->find(atom);
+        if (iter != frame->syms->end())
+        {
+            return &iter->second;
+        }
     }
-    return iter->second.binding;
+    return nullptr;
 }
 
-mdl_value_t *mdl_local_symbol_lookup_1_activation_only_please(const atom_t *atom, mdl_frame_t *frame)
+// the frame RETURN and AGAIN leave when not given an activation: the
+// innermost PROG or REPEAT, unless another activation comes first
+static mdl_frame_t *mdl_lastprog_frame(mdl_frame_t *frame)
 {
     while (frame)
     {
-        auto iter = frame->syms->find(atom);
-        if (iter != frame->syms->end())
+        mdl_local_symbol_t *sym = mdl_frame_binding(frame, mdl_value_atom_lastprog->v.a);
+        if (sym)
         {
-            return iter->second.binding;
+            return sym->binding->v.f;
+        }
+        if (frame->frame_flags & MDL_FRAME_FLAGS_LPROG)
+        {
+            return frame;
         }
         if (frame->frame_flags & MDL_FRAME_FLAGS_ACTIVATION)
         {
@@ -1851,79 +2554,67 @@ mdl_local_symbol_t *mdl_local_symbol_slot(atom_t *atom, mdl_frame_t *frame)
         mdl_error("Bad frame passed to local symbol lookup");
     }
 
-#ifdef CACHE_LOCAL_SYMBOLS
-    bool fixbind = frame == cur_frame;
-    // shortcut -- use atom's bind value
-    if (fixbind && atom->bindid == cur_process_bindid && atom->binding)
+    if (frame == cur_frame)
     {
+        if (frame != mdl_bound_frame)
+        {
+            mdl_rebind_frames(frame);
+        }
         return atom->binding;
     }
-#endif
-
-    mdl_local_symbol_table_t::iterator iter;
 
     while (frame)
     {
-        iter = frame->syms->find(atom);
-        if (iter != frame->syms->end())
+        mdl_local_symbol_t *sym = mdl_frame_binding(frame, atom);
+        if (sym)
         {
-            break;
+            return sym;
         }
         frame = frame->prev_frame;
     }
-    if (!frame)
-    {
-        return nullptr;
-    }
-
-#ifdef CACHE_LOCAL_SYMBOLS
-    if (fixbind)
-    {
-        atom->binding = &iter->second;
-        atom->bindid = cur_process_bindid;
-    }
-#endif
-    return &iter->second;
+    return nullptr;
 }
 
 mdl_value_t *mdl_bind_local_symbol(atom_t *atom, mdl_value_t *val, mdl_frame_t *frame, bool allow_replacement)
 {
-#ifdef CACHE_LOCAL_SYMBOLS
-    bool fixbind = frame == cur_frame;
-#endif
-
-    auto iter = frame->syms->find(atom);
-    if (iter != frame->syms->end())
+    mdl_local_symbol_t *slot = mdl_frame_binding(frame, atom);
+    if (slot)
     {
         if (!allow_replacement)
         {
             return nullptr;
         }
-        iter->second.binding = val;
+        slot->binding = val;
+        return val;
+    }
+
+    mdl_local_symbol_t sym;
+    sym.atom = atom;
+    sym.binding = val;
+    sym.prev_binding = nullptr;
+    if (frame->nsyms < MDL_FRAME_INLINE_SYMS)
+    {
+        slot = &frame->inline_syms[frame->nsyms++];
+        *slot = sym;
     }
     else
     {
-#ifdef CACHE_LOCAL_SYMBOLS
-        mdl_local_symbol_t *oldsym = mdl_local_symbol_slot(atom, frame);
-#endif
-        mdl_local_symbol_t sym;
-        sym.atom = atom;
-        sym.binding = val;
-#ifdef CACHE_LOCAL_SYMBOLS
-        sym.prev_binding = oldsym;
-#endif
-        auto insresult = frame->syms->emplace(atom, sym);
-#ifdef CACHE_LOCAL_SYMBOLS
-        if (fixbind)
+        if (!frame->syms)
         {
-            atom->binding = &insresult.first->second;
-            atom->bindid = cur_process_bindid;
+            frame->syms = new(UseGC) mdl_local_symbol_table_t();
         }
-        else
+        slot = &frame->syms->emplace(atom, sym).first->second;
+    }
+    if (frame->frame_flags & MDL_FRAME_FLAGS_BOUND)
+    {
+        // a binding under the innermost can only be slipped in if
+        // nothing above shadows it; otherwise unbind down to it first
+        if (frame != mdl_bound_frame && atom->binding)
         {
-            atom->binding = nullptr;
+            mdl_rebind_frames(frame);
         }
-#endif
+        slot->prev_binding = atom->binding;
+        atom->binding = slot;
     }
     return val;
 }
@@ -1980,329 +2671,120 @@ mdl_value_t *mdl_both_symbol_lookup_pname(const char *pname, mdl_frame_t *frame)
 }
 
 
-// bind arguments to function/prog/repeat in frame
-mdl_value_t *mdl_bind_args(mdl_value_t *fargs,
-                           mdl_value_t *apply_to, // functions only
-                           mdl_frame_t *frame,
-                           mdl_frame_t *prev_frame, // for "BIND"
-                           bool called_from_apply_subr,
-                           bool auxonly)
+// mdl_bind_args, for the argument list as mdl_fargs_spec has parsed it
+static mdl_value_t *mdl_bind_argspec(const mdl_argspec_t *spec,
+                                     mdl_value_t *fargs,
+                                     mdl_value_t *apply_to,
+                                     mdl_frame_t *frame,
+                                     mdl_frame_t *prev_frame,
+                                     bool called_from_apply_subr)
 {
-    mdl_value_t *mdl_value_atom_quote = mdl_get_atom_from_oblist("QUOTE", mdl_value_root_oblist);
-
     mdl_value_t *argptr = nullptr;
     if (apply_to)
     {
         argptr = LREST(apply_to, 1);
     }
 
-    if (!fargs || fargs->type != MDL_TYPE_LIST)
-    {
-        mdl_error("Formal arguments must be LIST");
-    }
-
-    mdl_value_t *fargp = LREST(fargs, 0);
-    enum {
-        ARGSTATE_INITIAL, // looking for atoms or string
-        ARGSTATE_BIND,    // just got the bind, looking for one atom
-        ARGSTATE_ATOMS,   // looking for atoms or string other than BIND
-        ARGSTATE_CALL,    // looking for a single atom
-        ARGSTATE_OPTIONAL,// looking for atoms, 2 lists, or string
-        ARGSTATE_ARGS,    // looking for a single atom
-        ARGSTATE_TUPLE,   // looking for a single atom
-        ARGSTATE_ANONLY,  // No more args, looking for AUX or NAME
-        ARGSTATE_AUX,     // looking for atoms or 2-lists
-        ARGSTATE_NAME,    // looking for atom
-        ARGSTATE_NOMORE   // that's it, nothing else
-    }
-    argstate = ARGSTATE_INITIAL;
-
-    if (auxonly)
-    {
-        argstate = ARGSTATE_AUX;
-    }
-
-    int args_processed = 0;
-    while (fargp)
+    for (int i = 0; i < spec->nslots; i++)
     {
-        mdl_value_t *farg = fargp->v.p.car;
-        mdl_value_t *default_val = &mdl_value_unassigned;
+        const mdl_argspec_slot_t *slot = &spec->slots[i];
+        mdl_value_t *val;
 
-        if (farg->type == MDL_TYPE_LIST)
+        switch (slot->kind)
         {
-            default_val = LITEM(farg, 1);
-            if (!default_val || LHASITEM(farg, 2))
+        case MDL_ARGSPEC_REQUIRED:
+        case MDL_ARGSPEC_OPTIONAL:
+            if (slot->quoted && called_from_apply_subr)
             {
-                mdl_error("Only lists allowed in arg lists are 2-lists");
-            }
-            farg = LITEM(farg, 0);
-            if (farg->type != MDL_TYPE_FORM && farg->type != MDL_TYPE_ATOM)
-            {
-                mdl_error("First element in 2-list must be atom or quoted atom");
-            }
-            if (argstate != ARGSTATE_OPTIONAL && argstate != ARGSTATE_AUX)
-            {
-                return mdl_call_error_ext("FIXME", "2-lists allowed only in OPTIONAL or AUX sections", nullptr);
+                mdl_error("Can't use APPLY to call a function with quoted arguments");
             }
-        }
-
-        if (farg->type == MDL_TYPE_STRING)
-        {
-            if (mdl_string_equal_cstr(&farg->v.s, "BIND"))
+            if (argptr)
             {
-                if (argstate != ARGSTATE_INITIAL)
+                val = argptr->v.p.car;
+                if (!slot->quoted && !called_from_apply_subr)
                 {
-                    mdl_error("BIND must be first thing in argument list");
+                    val = mdl_eval(val, false, mdl_make_frame_value(prev_frame));
                 }
-                argstate = ARGSTATE_BIND;
+                argptr = argptr->v.p.cdr;
             }
-            else if (mdl_string_equal_cstr(&farg->v.s, "CALL"))
+            else if (slot->kind == MDL_ARGSPEC_REQUIRED)
             {
-                if ((argstate != ARGSTATE_INITIAL && argstate != ARGSTATE_ATOMS) || args_processed)
-                {
-                    mdl_error("CALL must be the only argment-gatherer");
-                }
-                if (called_from_apply_subr)
+                if (slot->quoted)
                 {
-                    mdl_error("CALL not allowed when called from APPLY");
+                    mdl_error("Too few args in function call");
                 }
-                argstate = ARGSTATE_CALL;
+                return mdl_call_error("TOO-FEW-ARGUMENTS-SUPPLIED", frame->subr, nullptr);
             }
-            else if (mdl_string_equal_cstr(&farg->v.s, "OPT") ||
-                     mdl_string_equal_cstr(&farg->v.s, "OPTIONAL"))
+            else
             {
-                if (argstate != ARGSTATE_INITIAL && argstate != ARGSTATE_ATOMS)
+                val = slot->default_val;
+                if (val != &mdl_value_unassigned)
                 {
-                    mdl_error("OPTIONAL in wrong place in argument string");
+                    val = mdl_eval(val);
                 }
-                argstate = ARGSTATE_OPTIONAL;
             }
-            else if (mdl_string_equal_cstr(&farg->v.s, "ARGS"))
-            {
-                if (argstate != ARGSTATE_INITIAL &&
-                    argstate != ARGSTATE_ATOMS &&
-                    argstate != ARGSTATE_OPTIONAL)
-                {
-                    mdl_error("ARGS in wrong place in argument string");
-                }
-                if (called_from_apply_subr)
-                {
-                    mdl_error("ARGS not allowed when called from APPLY");
-                }
-                argstate = ARGSTATE_ARGS;
-            }
-            else if (mdl_string_equal_cstr(&farg->v.s, "TUPLE"))
+            break;
+        case MDL_ARGSPEC_BIND:
+            val = mdl_make_frame_value(prev_frame, MDL_TYPE_ENVIRONMENT);
+            break;
+        case MDL_ARGSPEC_CALL:
+            if (called_from_apply_subr)
             {
-                if (argstate != ARGSTATE_INITIAL &&
-                    argstate != ARGSTATE_ATOMS &&
-                    argstate != ARGSTATE_OPTIONAL)
-                {
-                    mdl_error("TUPLE in wrong place in argument string");
-                }
-                argstate = ARGSTATE_TUPLE;
+                mdl_error("CALL not allowed when called from APPLY");
             }
-            else if (mdl_string_equal_cstr(&farg->v.s, "AUX") ||
-                     mdl_string_equal_cstr(&farg->v.s, "EXTRA"))
+            val = apply_to;
+            argptr = nullptr;
+            break;
+        case MDL_ARGSPEC_ARGS:
+            if (called_from_apply_subr)
             {
-                if (argstate != ARGSTATE_INITIAL &&
-                    argstate != ARGSTATE_ATOMS &&
-                    argstate != ARGSTATE_OPTIONAL &&
-                    argstate != ARGSTATE_ANONLY)
-                {
-                    mdl_error("AUX/EXTRA in wrong place in argument string");
-                }
-                argstate = ARGSTATE_AUX;
+                mdl_error("ARGS not allowed when called from APPLY");
             }
-            else if (mdl_string_equal_cstr(&farg->v.s, "NAME") ||
-                     mdl_string_equal_cstr(&farg->v.s, "ACT"))
-            {
-                if (argstate != ARGSTATE_INITIAL &&
-                    argstate != ARGSTATE_ATOMS &&
-                    argstate != ARGSTATE_OPTIONAL &&
-                    argstate != ARGSTATE_ANONLY &&
-                    argstate != ARGSTATE_AUX)
-                {
-                    mdl_error("NAME/ACT in wrong place in argument string");
-                }
-                argstate = ARGSTATE_NAME;
-            }
-        }
-        else if (farg->type == MDL_TYPE_ATOM)
-        {
-            switch (argstate)
+            val = mdl_make_list(argptr);
+            argptr = nullptr;
+            break;
+        case MDL_ARGSPEC_TUPLE:
+            if (!called_from_apply_subr)
             {
-            case ARGSTATE_INITIAL:
-            case ARGSTATE_ATOMS:
-            case ARGSTATE_OPTIONAL:
-                if (argptr)
-                {
-                    mdl_value_t *arg = argptr->v.p.car;
-                    if (!called_from_apply_subr)
-                    {
-                        arg = mdl_eval(arg, false, mdl_make_frame_value(prev_frame));
-                    }
-                    if (!mdl_bind_local_symbol(farg->v.a, arg, frame, false))
-                    {
-                        return mdl_call_error_ext("BAD-ARGUMENT-LIST", "Duplicate formal argument", farg, fargs, nullptr);
-                    }
-                    argptr = argptr->v.p.cdr;
-                    args_processed++;
-                }
-                else if (argstate != ARGSTATE_OPTIONAL)
-                {
-                    return mdl_call_error("TOO-FEW-ARGUMENTS-SUPPLIED", frame->subr, nullptr);
-                }
-                else
-                {
-                    if (default_val != &mdl_value_unassigned)
-                    {
-                        default_val = mdl_eval(default_val);
-                    }
+                mdl_frame_t *save_frame = cur_frame;
+                cur_frame = prev_frame;
 
-                    if (!mdl_bind_local_symbol(farg->v.a, default_val, frame, false))
-                    {
-                        return mdl_call_error_ext("BAD-ARGUMENT-LIST", "Duplicate formal argument", farg, fargs, nullptr);
-                    }
-                }
-                break;
-            case ARGSTATE_BIND:
-            {
-                mdl_value_t *pframeval = mdl_make_frame_value(prev_frame, MDL_TYPE_ENVIRONMENT);
-                if (!mdl_bind_local_symbol(farg->v.a, pframeval, frame, false))
+                val = mdl_std_eval(mdl_make_list(argptr), false, MDL_TYPE_LIST);
+                if (val)
                 {
-                    return mdl_call_error_ext("BAD-ARGUMENT-LIST", "Duplicate formal argument", farg, fargs, nullptr);
+                    val = mdl_make_tuple(LREST(val, 0), MDL_TYPE_TUPLE);
                 }
-                argstate = ARGSTATE_ATOMS;
-                break;
+                cur_frame = save_frame;
             }
-            case ARGSTATE_CALL:
-                if (!mdl_bind_local_symbol(farg->v.a, apply_to, frame, false))
-                {
-                    return mdl_call_error_ext("BAD-ARGUMENT-LIST", "Duplicate formal argument", farg, fargs, nullptr);
-                }
-                argstate = ARGSTATE_ANONLY;
-                argptr = nullptr;
-                break;
-            case ARGSTATE_ARGS:
+            else
             {
-                mdl_value_t *argsval = mdl_make_list(argptr);
-                if (!mdl_bind_local_symbol(farg->v.a, argsval, frame, false))
-                {
-                    return mdl_call_error_ext("BAD-ARGUMENT-LIST", "Duplicate formal argument", farg, fargs, nullptr);
-                }
-                argstate = ARGSTATE_ANONLY;
-                argptr = nullptr;
-                break;
+                val = mdl_make_tuple(argptr, MDL_TYPE_TUPLE);
             }
-            case ARGSTATE_TUPLE:
+            argptr = nullptr;
+            break;
+        case MDL_ARGSPEC_NAME:
+            val = mdl_make_frame_value(frame, MDL_TYPE_ACTIVATION);
+            break;
+        case MDL_ARGSPEC_AUX:
+            val = slot->default_val;
+            if (val != &mdl_value_unassigned)
             {
-                // fixme -- need a better way of switching frames
-                // probably just need to switch at AUX or first time
-                // OPT argument isn't found
-                mdl_value_t *argsval;
-                if (!called_from_apply_subr)
-                {
-                    mdl_frame_t *save_frame = cur_frame;
-                    cur_frame = prev_frame;
-
-                    argsval = mdl_std_eval(mdl_make_list(argptr), false, MDL_TYPE_LIST);
-                    if (argsval)
-                    {
-                        argsval = mdl_make_tuple(LREST(argsval, 0), MDL_TYPE_TUPLE);
-                    }
-                    cur_frame = save_frame;
-                }
-                else
-                {
-                    argsval = mdl_make_tuple(argptr, MDL_TYPE_TUPLE);
-                }
-                if (!mdl_bind_local_symbol(farg->v.a, argsval, frame, false))
-                {
-                    return mdl_call_error_ext("BAD-ARGUMENT-LIST", "Duplicate formal argument", farg, fargs, nullptr);
-                }
-                argstate = ARGSTATE_ANONLY;
-                argptr = nullptr;
-                break;
+                val = mdl_eval(val);
             }
-            case ARGSTATE_NAME:
+            break;
+        case MDL_ARGSPEC_CALL_ERROR:
+            return mdl_call_error_ext("FIXME", slot->error, nullptr);
+        default: // MDL_ARGSPEC_ERROR
+            if (slot->quoted && called_from_apply_subr)
             {
-                mdl_value_t *cframeval = mdl_make_frame_value(frame, MDL_TYPE_ACTIVATION);
-                if (!mdl_bind_local_symbol(farg->v.a, cframeval, frame, false))
-                {
-                    return mdl_call_error_ext("BAD-ARGUMENT-LIST", "Duplicate formal argument", farg, fargs, nullptr);
-                }
-                argstate = ARGSTATE_NOMORE;
-                break;
-            }
-            case ARGSTATE_AUX:
-                if (default_val != &mdl_value_unassigned)
-                {
-                    default_val = mdl_eval(default_val);
-                }
-                if (!mdl_bind_local_symbol(farg->v.a, default_val, frame, false))
-                {
-                    return mdl_call_error_ext("BAD-ARGUMENT-LIST", "Duplicate formal argument", farg, fargs, nullptr);
-                }
-                break;
-            default:
-                mdl_error("Unexpected ATOM in formal argument list");
-                break;
+                mdl_error("Can't use APPLY to call a function with quoted arguments");
             }
+            mdl_error(slot->error);
         }
-        else if (farg->type == MDL_TYPE_FORM)
+        if (!mdl_bind_local_symbol(slot->atom, val, frame, false))
         {
-            mdl_value_t *atom = LITEM(farg, 1);
-            mdl_value_t *quote = LITEM(farg, 0);
-            if (!atom ||
-                atom->type != MDL_TYPE_ATOM ||
-                LHASITEM(farg, 2) ||
-                !mdl_value_equal(quote, mdl_value_atom_quote))
-            {
-                mdl_error("FORM in arg list may only be <QUOTE atom>");
-            }
-            if (called_from_apply_subr)
-            {
-                mdl_error("Can't use APPLY to call a function with quoted arguments");
-            }
-
-            switch (argstate)
-            {
-            case ARGSTATE_INITIAL:
-            case ARGSTATE_ATOMS:
-            case ARGSTATE_OPTIONAL:
-                if (argptr)
-                {
-                    mdl_value_t *arg = argptr->v.p.car;
-                    if (!mdl_bind_local_symbol(atom->v.a, arg, frame, false))
-                    {
-                        return mdl_call_error_ext("BAD-ARGUMENT-LIST", "Duplicate formal argument", farg, fargs, nullptr);
-                    }
-                    argptr = argptr->v.p.cdr;
-                    args_processed++;
-                }
-                else if (argstate != ARGSTATE_OPTIONAL)
-                {
-                    mdl_error("Too few args in function call");
-                }
-                else
-                {
-                    if (default_val != &mdl_value_unassigned)
-                    {
-                        default_val = mdl_eval(default_val);
-                    }
-
-                    if (!mdl_bind_local_symbol(atom->v.a, default_val, frame, false))
-                    {
-                        return mdl_call_error_ext("BAD-ARGUMENT-LIST", "Duplicate formal argument", farg, fargs, nullptr);
-                    }
-                }
-                break;
-            default:
-                mdl_error("Unexpected quoted ATOM in formal argument list");
-                break;
-            }
+            return mdl_call_error_ext("BAD-ARGUMENT-LIST", "Duplicate formal argument", slot->farg, fargs, nullptr);
         }
-        fargp = fargp->v.p.cdr;
     }
     if (argptr != nullptr)
     {
@@ -2311,9 +2793,25 @@ mdl_value_t *mdl_bind_args(mdl_value_t *fargs,
     return nullptr;
 }
 
-mdl_value_t *mdl_internal_prog_repeat_bind(mdl_value_t *orig_form, bool bind_to_lastprog, bool repeat)
+// bind arguments to function/prog/repeat in frame
+mdl_value_t *mdl_bind_args(mdl_value_t *fargs,
+                           mdl_value_t *apply_to, // functions only
+                           mdl_frame_t *frame,
+                           mdl_frame_t *prev_frame, // for "BIND"
+                           bool called_from_apply_subr,
+                           bool auxonly)
 {
-    mdl_frame_t *frame = mdl_new_frame();
+    if (!fargs || fargs->type != MDL_TYPE_LIST)
+    {
+        mdl_error("Formal arguments must be LIST");
+    }
+
+    return mdl_bind_argspec(mdl_fargs_spec(fargs, auxonly), fargs, apply_to, frame, prev_frame, called_from_apply_subr);
+}
+
+mdl_value_t *mdl_internal_prog_repeat_bind(mdl_value_t *orig_form, bool bind_to_lastprog, bool repeat, mdl_code_t *code)
+{
+    mdl_frame_t *frame = mdl_new_pooled_frame();
     mdl_frame_t *prev_frame = cur_frame;
     mdl_value_t *fargsp = LREST(orig_form, 1);
     mdl_value_t *act_atom = nullptr;
@@ -2327,20 +2825,19 @@ mdl_value_t *mdl_internal_prog_repeat_bind(mdl_value_t *orig_form, bool bind_to_
 
     mdl_value_t *fargs = fargsp->v.p.car;
 
-    if (bind_to_lastprog || act_atom)
+    // only a named activation can escape; RETURN and AGAIN find an
+    // unnamed one by its flags, so its frame stays poolable
+    if (act_atom)
     {
         mdl_value_t *activation = mdl_make_frame_value(frame, MDL_TYPE_ACTIVATION);
-        if (bind_to_lastprog)
-        {
-            mdl_bind_local_symbol(mdl_value_atom_lastprog->v.a, activation, frame, false);
-        }
-        if (act_atom)
-        {
-            mdl_bind_local_symbol(act_atom->v.a, activation, frame, false);
-        }
+        mdl_bind_local_symbol(act_atom->v.a, activation, frame, false);
     }
 
-    frame->frame_flags = MDL_FRAME_FLAGS_ACTIVATION;
+    frame->frame_flags |= MDL_FRAME_FLAGS_ACTIVATION | MDL_FRAME_FLAGS_CATCH;
+    if (bind_to_lastprog)
+    {
+        frame->frame_flags |= MDL_FRAME_FLAGS_LPROG;
+    }
     mdl_push_frame(frame);
 
     mdl_bind_args(fargs, nullptr, frame, prev_frame,
@@ -2348,39 +2845,70 @@ mdl_value_t *mdl_internal_prog_repeat_bind(mdl_value_t *orig_form, bool bind_to_
         true /* AUX arguments only */
     );
 
-    int jumpval = mdl_setjmp(frame->interp_frame);
-    // RETURN and AGAIN come here
-    bool first = (jumpval == 0) || (jumpval == LONGJMP_AGAIN);
+    if (!code)
+    {
+        code = mdl_body_code(fargsp->v.p.cdr);
+    }
+
+    size_t argtop = mdl_argstack_top;
+    bool first = true;
     while (first || (repeat && !frame->result))
     {
         first = false;
-        mdl_value_t *fexprs = fargsp->v.p.cdr;
-        mdl_value_t *mdl_last_value = nullptr;
-        while (fexprs)
-        {
-            mdl_last_value = mdl_eval(fexprs->v.p.car, false);
-            fexprs = fexprs->v.p.cdr;
-        }
-        if (mdl_last_value == nullptr)
+        try
         {
-            mdl_last_value = mdl_call_error("HAS_EMPTY_BODY", nullptr);
+            mdl_value_t *mdl_last_value = nullptr;
+            if (code)
+            {
+                mdl_last_value = mdl_run_code(code);
+            }
+            else
+            {
+                mdl_value_t *fexprs = fargsp->v.p.cdr;
+                while (fexprs)
+                {
+                    mdl_last_value = mdl_eval(fexprs->v.p.car, false);
+                    fexprs = fexprs->v.p.cdr;
+                }
+            }
+            if (mdl_last_value == nullptr)
+            {
+                mdl_last_value = mdl_call_error("HAS_EMPTY_BODY", nullptr);
+            }
+            if (mdl_last_value == &mdl_value_tail_call)
+            {
+                // leave the frame for mdl_apply_function
+                frame->tail_code = code;
+                return mdl_last_value;
+            }
+            if (!repeat)
+            {
+                frame->result = mdl_last_value;
+            }
         }
-        if (!repeat)
+        catch (const mdl_frame_jump_t &jump)
         {
-            frame->result = mdl_last_value;
+            if (jump.frame != frame) throw;
+            // RETURN and AGAIN come here
+            first = (jump.value == LONGJMP_AGAIN);
+            mdl_argstack_top = argtop;
         }
     }
     mdl_pop_frame(frame->prev_frame);
-    return frame->result;
+    mdl_value_t *result = frame->result;
+    mdl_release_frame(frame);
+    return result;
 }
 
-mdl_value_t *mdl_apply_function(mdl_value_t *applier, mdl_value_t *apply_to, bool called_from_apply_subr)
+// push a frame for applying a FUNCTION and bind its arguments in it.
+// Returns the value to return from ERRET if binding fails
+static mdl_value_t *mdl_push_function_frame(mdl_value_t *applier, mdl_value_t *apply_to, bool called_from_apply_subr)
 {
-    mdl_frame_t *frame = mdl_new_frame();
+    mdl_frame_t *frame = mdl_new_pooled_frame();
     mdl_frame_t *prev_frame = cur_frame;
 
     frame->prev_frame = prev_frame;
-    frame->frame_flags = MDL_FRAME_FLAGS_ACTIVATION;
+    frame->frame_flags |= MDL_FRAME_FLAGS_ACTIVATION | MDL_FRAME_FLAGS_CATCH;
     mdl_value_t *fname = LITEM(apply_to, 0);
     if (fname->type == MDL_TYPE_ATOM)
     {
@@ -2406,36 +2934,193 @@ mdl_value_t *mdl_apply_function(mdl_value_t *applier, mdl_value_t *apply_to, boo
     }
 
     mdl_push_frame(frame);
-    if (!mdl_setjmp(frame->interp_frame))
+    // mdl_bind_args returns NULL on success, return from ERRET on error
+    frame->result = mdl_bind_args(fargs, apply_to, frame,
+        prev_frame, called_from_apply_subr, false
+    );
+    frame->tail_code = mdl_function_code(applier);
+    return frame->result;
+}
+
+static bool mdl_frame_is_above(mdl_frame_t *frame, mdl_frame_t *base)
+{
+    for (; frame; frame = frame->prev_frame)
     {
-        // mdl_bind_args returns NULL on success, return from ERRET on error
-        frame->result = mdl_bind_args(fargs, apply_to, frame,
-            prev_frame, called_from_apply_subr, false
-        );
+        if (frame->prev_frame == base)
+        {
+            return true;
+        }
     }
+    return false;
+}
 
-    // RETURN and AGAIN come here (if there is an activation)
-    if (!frame->result)
+// Whether the callee of a tail call can't see the bindings of the frames
+// left for it, above base: each is one the callee makes too, before it
+// evaluates anything.  Nothing else may refer to the frames either
+static bool mdl_tail_frames_unneeded(mdl_frame_t *base, mdl_value_t *applier)
+{
+    if (applier->pt != PRIMTYPE_LIST || !applier->v.p.cdr)
+    {
+        return false;
+    }
+    mdl_value_t *fargsp = applier->v.p.cdr;
+    if (fargsp->v.p.car && fargsp->v.p.car->type == MDL_TYPE_ATOM)
+    {
+        fargsp = fargsp->v.p.cdr;
+    }
+    mdl_argspec_t *spec = fargsp ? mdl_fargs_spec(fargsp->v.p.car, false) : nullptr;
+    if (!spec || spec->bad)
+    {
+        return false;
+    }
+    // the atoms bound before the first default is evaluated
+    int nearly = 0;
+    while (nearly < spec->nslots)
+    {
+        const mdl_argspec_slot_t *slot = &spec->slots[nearly];
+        if (slot->kind == MDL_ARGSPEC_BIND ||
+            ((slot->kind == MDL_ARGSPEC_OPTIONAL || slot->kind == MDL_ARGSPEC_AUX) &&
+             slot->default_val != &mdl_value_unassigned))
+        {
+            break;
+        }
+        nearly++;
+    }
+    auto bound_early = [spec, nearly](const atom_t *atom)
+    {
+        for (int i = 0; i < nearly; i++)
+        {
+            if (spec->slots[i].atom == atom)
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+    for (mdl_frame_t *f = cur_frame; f != base; f = f->prev_frame)
     {
-        mdl_value_t *fexprs = LREST(applier, 1);
-        mdl_value_t *mdl_last_value = nullptr;
-        while (fexprs)
+        if (f->frame_flags & (MDL_FRAME_FLAGS_CAPTURED | MDL_FRAME_FLAGS_UNWIND))
         {
-            mdl_last_value = mdl_eval(fexprs->v.p.car, false);
-            fexprs = fexprs->v.p.cdr;
+            return false;
+        }
+        for (int i = 0; i < f->nsyms; i++)
+        {
+            if (!bound_early(f->inline_syms[i].atom))
+            {
+                return false;
+            }
         }
-        if (mdl_last_value == nullptr)
+        if (f->syms)
         {
-            mdl_last_value = mdl_call_error("HAS-EMPTY-BODY", nullptr);
+            for (auto &elem : *f->syms)
+            {
+                if (!bound_early(elem.second.atom))
+                {
+                    return false;
+                }
+            }
         }
-        frame->result = mdl_last_value;
     }
+    return true;
+}
 
-    mdl_pop_frame(frame->prev_frame);
-    return frame->result;
+static void mdl_pop_frames_to(mdl_frame_t *base)
+{
+    while (cur_frame != base)
+    {
+        mdl_frame_t *popped = cur_frame;
+        mdl_pop_frame(popped->prev_frame);
+        mdl_release_frame(popped);
+    }
+}
+
+// A body that ends by calling another FUNCTION returns
+// mdl_value_tail_call with its frames still pushed.  The callee is
+// applied here, so a chain of tail calls uses no more C stack than one
+// call.  If the callee can't see the frames' bindings -- a function
+// calling itself, typically -- they are popped first; otherwise the
+// callee runs above them, and they aren't counted against the depth
+// limit.  Everything from base_frame up belongs to this call, and is
+// popped when it returns
+mdl_value_t *mdl_apply_function(mdl_value_t *applier, mdl_value_t *apply_to, bool called_from_apply_subr)
+{
+    mdl_frame_t *base_frame = cur_frame;
+    mdl_value_t *first_applier = applier;
+    size_t argtop = mdl_argstack_top;
+    mdl_frame_t *frame = nullptr; // frame to run again, if any
+    mdl_value_t *result;
+    for (;;)
+    {
+        try
+        {
+            if (!frame)
+            {
+                result = mdl_push_function_frame(applier, apply_to, called_from_apply_subr);
+                if (result)
+                {
+                    break;
+                }
+                frame = cur_frame;
+            }
+
+            if (frame->tail_code)
+            {
+                result = mdl_run_code(frame->tail_code);
+            }
+            else
+            {
+                // only the first function can be uncompiled
+                result = nullptr;
+                mdl_value_t *fexprs = LREST(first_applier, 1);
+                while (fexprs)
+                {
+                    result = mdl_eval(fexprs->v.p.car, false);
+                    fexprs = fexprs->v.p.cdr;
+                }
+            }
+            if (result == nullptr)
+            {
+                result = mdl_call_error("HAS-EMPTY-BODY", nullptr);
+            }
+            if (result != &mdl_value_tail_call)
+            {
+                break;
+            }
+            applier = mdl_tail_applier;
+            apply_to = mdl_tail_apply_to;
+            called_from_apply_subr = true;
+            frame = nullptr;
+            if (mdl_tail_frames_unneeded(base_frame, applier))
+            {
+                mdl_pop_frames_to(base_frame);
+            }
+            else
+            {
+                cur_frame->kept = cur_frame->depth - base_frame->depth + base_frame->kept;
+            }
+        }
+        catch (const mdl_frame_jump_t &jump)
+        {
+            if (!mdl_frame_is_above(jump.frame, base_frame)) throw;
+            // RETURN and AGAIN come here (if there is an activation), and
+            // ERRET and RETRY to COND or PROG frames left by a tail call
+            mdl_argstack_top = argtop;
+            frame = jump.frame;
+            if (jump.value != LONGJMP_AGAIN && jump.value != LONGJMP_RETRY && frame->result)
+            {
+                result = frame->result;
+                break;
+            }
+        }
+    }
+
+    mdl_pop_frames_to(base_frame);
+    return result;
 }
 
-mdl_value_t *mdl_internal_expand(mdl_value_t *arg)
+// read_globals, if given, is set if applying the MACRO looked up any
+// GVAL (looking up the MACRO itself doesn't count)
+mdl_value_t *mdl_internal_expand(mdl_value_t *arg, bool *read_globals)
 {
     mdl_value_t *macro;
     mdl_value_t *result;
@@ -2443,9 +3128,10 @@ mdl_value_t *mdl_internal_expand(mdl_value_t *arg)
     mdl_frame_t *expand_frame = mdl_new_frame();
     expand_frame->subr = cur_frame->subr;
     mdl_frame_t *save_frame = cur_frame;
-    NEW_BINDID(cur_process_bindid);
+    jmp_buf jump;
+    expand_frame->interp_frame = &jump;
     int jumpval;
-    if ((jumpval = mdl_setjmp(expand_frame->interp_frame)) != 0)
+    if ((jumpval = mdl_setjmp(jump)) != 0)
     {
         // error handling
         mdl_longjmp_to(save_frame, jumpval);
@@ -2460,7 +3146,12 @@ mdl_value_t *mdl_internal_expand(mdl_value_t *arg)
 //        std::printf("\non form\n");
 //        mdl_print_value(stdout, arg);
 //        std::printf("\n");
+        size_t reads = mdl_global_reads;
         result = mdl_apply_function(macro, arg, false);
+        if (read_globals)
+        {
+            *read_globals = mdl_global_reads != reads;
+        }
     }
     else
     {
@@ -2469,7 +3160,6 @@ mdl_value_t *mdl_internal_expand(mdl_value_t *arg)
         result = mdl_eval(arg, false);
     }
     cur_frame = save_frame;
-    NEW_BINDID(cur_process_bindid);
     return result;
 }
 
@@ -2496,6 +3186,62 @@ bool mdl_type_is_applicable(int type)
     }
 }
 
+// call a SUBR or FSUBR on an already-built argument list.  With code,
+// the F/SUBR's frame runs that compiled in-line version instead
+mdl_value_t *mdl_apply_built_in(mdl_value_t *applier, mdl_value_t *apply_to, mdl_value_t *arglist, mdl_code_t *code)
+{
+    if (applier->v.w >= built_in_table.size())
+    {
+        mdl_error("Invalid built-in");
+    }
+
+    mdl_frame_t *frame = mdl_new_pooled_frame();
+    mdl_built_in_t built_in = built_in_table[applier->v.w];
+    frame->subr = built_in.a;
+    frame->args = arglist;
+    frame->prev_frame = cur_frame;
+    frame->frame_flags |= MDL_FRAME_FLAGS_TRUEFRAME | MDL_FRAME_FLAGS_CATCH;
+    mdl_push_frame(frame);
+
+    size_t argtop = mdl_argstack_top;
+    mdl_value_t *result = nullptr;
+    int jumpval = 0;
+    while (jumpval == 0 || jumpval == LONGJMP_RETRY)
+    {
+        try
+        {
+            result = code ? mdl_run_code(code) : built_in.proc(apply_to, arglist);
+            if (result == &mdl_value_tail_call)
+            {
+                // leave the frame for mdl_apply_function
+                frame->tail_code = code;
+                return result;
+            }
+            break;
+        }
+        catch (const mdl_frame_jump_t &jump)
+        {
+            if (jump.frame != frame) throw;
+            jumpval = jump.value;
+        }
+        mdl_argstack_top = argtop;
+        // out of the handler before jumping anywhere else
+        if (jumpval == LONGJMP_ERRET)
+        {
+            result = frame->result;
+        }
+        else if (jumpval != LONGJMP_RETRY)
+        {
+            std::fprintf(stderr, "Bad longjmp in F/SUBR apply: %d", jumpval);
+            // Huh?  pass it on
+            mdl_longjmp_to(cur_frame->prev_frame, jumpval);
+        }
+    }
+    mdl_pop_frame(frame->prev_frame);
+    mdl_release_frame(frame);
+    return result;
+}
+
 // this is not the SUBR APPLY.  Rather, it is the internal function used to
 // apply things.  The apply_to is the FORM to be applied, including the
 // first element.
@@ -2512,54 +3258,20 @@ mdl_value_t *mdl_std_apply(mdl_value_t *applier, mdl_value_t *apply_to, int appl
 
     if (apply_as == MDL_TYPE_SUBR || apply_as == MDL_TYPE_FSUBR)
     {
-        if (applier->v.w < built_in_table.size())
+        if (apply_as == MDL_TYPE_FSUBR && called_from_apply_subr)
         {
-            if (apply_as == MDL_TYPE_FSUBR && called_from_apply_subr)
-            {
-                mdl_error("Can't use APPLY with FSUBRs");
-            }
-
-            mdl_frame_t *frame = mdl_new_frame();
-            mdl_built_in_t built_in = built_in_table[applier->v.w];
-            frame->subr = built_in.a;
-
-            mdl_value_t *arglist;
-            if (apply_as == MDL_TYPE_FSUBR || called_from_apply_subr)
-            {
-                arglist = mdl_make_list(apply_to->v.p.cdr->v.p.cdr);
-            }
-            else
-            {
-                arglist = mdl_std_eval(mdl_make_list(apply_to->v.p.cdr->v.p.cdr));
-            }
-            frame->args = arglist;
-            frame->prev_frame = cur_frame;
-            frame->frame_flags = MDL_FRAME_FLAGS_TRUEFRAME;
-            mdl_push_frame(frame);
-            int jumpval = mdl_setjmp(frame->interp_frame);
-
-            mdl_value_t *result;
-            if (jumpval == 0 || jumpval == LONGJMP_RETRY)
-            {
-                result = built_in.proc(apply_to, arglist);
-            }
-            else if (jumpval == LONGJMP_ERRET)
-            {
-                result = frame->result;
-            }
-            else
-            {
-                std::fprintf(stderr, "Bad longjmp in F/SUBR apply: %d", jumpval);
-                // Huh?  pass it on
-                mdl_longjmp_to(cur_frame->prev_frame, jumpval);
-            }
-            mdl_pop_frame(frame->prev_frame);
-            return result;
+            mdl_error("Can't use APPLY with FSUBRs");
         }
-        else
+
+        if (apply_as == MDL_TYPE_FSUBR || called_from_apply_subr)
         {
-            mdl_error("Invalid built-in");
+            return mdl_apply_built_in(applier, apply_to, mdl_make_list(apply_to->v.p.cdr->v.p.cdr));
         }
+        size_t argtop = mdl_argstack_top;
+        mdl_value_t *arglist = mdl_argstack_eval_args(apply_to->v.p.cdr->v.p.cdr);
+        mdl_value_t *result = mdl_apply_built_in(applier, apply_to, arglist);
+        mdl_argstack_top = argtop;
+        return result;
     }
     else if (apply_as == MDL_TYPE_FUNCTION)
     {
@@ -2571,7 +3283,7 @@ mdl_value_t *mdl_std_apply(mdl_value_t *applier, mdl_value_t *apply_to, int appl
         {
             mdl_error("Can't use APPLY with MACROs"); // I don't think
         }
-        return mdl_eval(mdl_internal_expand(apply_to), false);
+        return mdl_eval(mdl_expand_form(applier, apply_to), false);
     }
     else if (apply_as == MDL_TYPE_FIX)
     {
@@ -2631,6 +3343,10 @@ mdl_value_t *mdl_std_apply(mdl_value_t *applier, mdl_value_t *apply_to, int appl
 mdl_value_t *mdl_internal_apply(mdl_value_t *applier, mdl_value_t *apply_to, bool called_from_apply_subr)
 {
     int apply_as = MDL_TYPE_NOTATYPE;
+    if (!(MDL_TYPE_FLAGS(applier->type) & MDL_TYPE_FLAG_APPLYTYPE))
+    {
+        return mdl_std_apply(applier, apply_to, apply_as, called_from_apply_subr);
+    }
     mdl_value_t *applytype = mdl_get_applytype(applier->type);
 
     if (applytype && applytype->type != MDL_TYPE_ATOM)
@@ -2658,6 +3374,10 @@ int mdl_eval_type(int t)
 {
     // the type this type evaluates as, or MDL_TYPE_NOTATYPE
     // for custom evaluation
+    if (!(MDL_TYPE_FLAGS(t) & MDL_TYPE_FLAG_EVALTYPE))
+    {
+        return t;
+    }
     mdl_value_t *evaltype = mdl_get_evaltype(t);
     if (evaltype)
     {
@@ -2674,6 +3394,10 @@ int mdl_apply_type(int t)
 {
     // the type this type ultmately should be applied as, or MDL_TYPE_NOTATYPE
     // for custom application
+    if (!(MDL_TYPE_FLAGS(t) & MDL_TYPE_FLAG_APPLYTYPE))
+    {
+        return t;
+    }
     mdl_value_t *applytype = mdl_get_applytype(t);
     if (applytype)
     {
@@ -2751,9 +3475,7 @@ mdl_value_t *mdl_next_string_element(mdl_struct_walker_t *w)
     {
         return nullptr;
     }
-    mdl_value_t *result = mdl_new_fix((int)(*w->se));
-    result->type = MDL_TYPE_CHARACTER;
-    return result;
+    return mdl_new_word(*w->se, MDL_TYPE_CHARACTER);
 }
 
 mdl_value_t *mdl_rest_string_element(mdl_struct_walker_t *w)
@@ -3047,15 +3769,64 @@ void mdl_resize_vector(mdl_value_t *v, int addend, int addbeg, bool makelose)
     }
 }
 
+// Call-site cache for the appliers of forms.  There's no room in a
+// FORM for a cache slot, so the sites are kept in a small direct-mapped
+// table keyed by the form's first cons cell.  Only SUBRs, FSUBRs,
+// FUNCTIONs and MACROs found through a global value are cached;
+// replacing a global binding of one of those bumps mdl_global_epoch,
+// which invalidates every entry at once.
+#define MDL_CALL_SITE_CACHE_SIZE 1024
+
+struct mdl_call_site_t
+{
+    const mdl_value_t *site;
+    const atom_t *atom;
+    mdl_value_t *applier;
+    unsigned epoch;
+};
+
+static mdl_call_site_t mdl_call_site_cache[MDL_CALL_SITE_CACHE_SIZE];
+
+static inline bool mdl_type_is_cached_applier(int type)
+{
+    return type == MDL_TYPE_SUBR || type == MDL_TYPE_FSUBR ||
+        type == MDL_TYPE_FUNCTION || type == MDL_TYPE_MACRO;
+}
+
+static inline mdl_call_site_t *mdl_call_site_slot(const mdl_value_t *site)
+{
+    uintptr_t h = (uintptr_t)site;
+    h ^= h >> 12;
+    return &mdl_call_site_cache[(h >> 4) & (MDL_CALL_SITE_CACHE_SIZE - 1)];
+}
+
 //mdl_eval_apply_expr does the special evaluation of the first
 //item of a form -- if an atom, returns gval, then lval, otherwise
 //standard application
-mdl_value_t *mdl_eval_apply_expr(mdl_value_t *appl_expr)
+mdl_value_t *mdl_eval_apply_expr(mdl_value_t *appl_expr, const mdl_value_t *site)
 {
     mdl_value_t *applier;
     if (appl_expr->type == MDL_TYPE_ATOM)
     {
+        mdl_call_site_t *cs = nullptr;
+        if (site)
+        {
+            cs = mdl_call_site_slot(site);
+            if (cs->site == site && cs->atom == appl_expr->v.a &&
+                cs->epoch == mdl_global_epoch)
+            {
+                return cs->applier;
+            }
+        }
         applier = mdl_global_symbol_lookup(appl_expr->v.a);
+        if (cs && applier && mdl_type_is_cached_applier(applier->type))
+        {
+            cs->site = site;
+            cs->atom = appl_expr->v.a;
+            cs->applier = applier;
+            cs->epoch = mdl_global_epoch;
+            return applier;
+        }
         if (!applier || applier->type == MDL_TYPE_UNBOUND)
         {
             applier = mdl_local_symbol_lookup(appl_expr->v.a);
@@ -3072,9 +3843,56 @@ mdl_value_t *mdl_eval_apply_expr(mdl_value_t *appl_expr)
     return applier;
 }
 
+// the SUBR argument list for the arguments in rest, with segments
+// spliced in as mdl_std_eval does for a LIST
+mdl_value_t *mdl_argstack_eval_args(mdl_value_t *rest)
+{
+    mdl_value_t *result = mdl_argstack_make_list(nullptr);
+    mdl_value_t *lastitem = result;
+    while (rest)
+    {
+        mdl_value_t *item = rest->v.p.car;
+        rest = rest->v.p.cdr;
+        if (mdl_eval_type(item->type) == MDL_TYPE_SEGMENT)
+        {
+            mdl_value_t *seg = mdl_eval(item, true);
+            if (mdl_primtype_nonstructured(seg->pt))
+            {
+                return mdl_call_error_ext("ILLEGAL-SEGMENT", "Segment evaluated to nonstructured type", item, nullptr);
+            }
+            if (!rest && seg->pt == PRIMTYPE_LIST)
+            {
+                lastitem->v.p.cdr = seg->v.p.cdr;
+            }
+            else
+            {
+                mdl_value_t *elem;
+                mdl_struct_walker_t w;
+
+                mdl_init_struct_walker(&w, seg);
+                elem = w.next(&w);
+                while (elem)
+                {
+                    lastitem->v.p.cdr = mdl_argstack_cons(elem, nullptr);
+                    lastitem = lastitem->v.p.cdr;
+                    elem = w.next(&w);
+                }
+            }
+        }
+        else
+        {
+            mdl_value_t *newitem = mdl_eval(item, true);
+            lastitem->v.p.cdr = mdl_argstack_cons(newitem, nullptr);
+            lastitem = lastitem->v.p.cdr;
+        }
+    }
+    return result;
+}
+
 mdl_value_t *mdl_std_eval(mdl_value_t *l, bool in_struct, int as_type)
 {
     mdl_value_t *result = nullptr;
+    mdl_check_stack();
     if (as_type == MDL_TYPE_NOTATYPE)
     {
         as_type = l->type;
@@ -3151,7 +3969,7 @@ mdl_value_t *mdl_std_eval(mdl_value_t *l, bool in_struct, int as_type)
         if (l->v.p.cdr)
         {
             mdl_value_t *appl_expr = (l->v.p.cdr->v.p.car);
-            mdl_value_t *applier = mdl_eval_apply_expr(appl_expr);
+            mdl_value_t *applier = mdl_eval_apply_expr(appl_expr, l->v.p.cdr);
             result =  mdl_internal_apply(applier, l, false);
         }
         else
@@ -3275,12 +4093,24 @@ mdl_value_t *mdl_std_eval(mdl_value_t *l, bool in_struct, int as_type)
 
 mdl_value_t *mdl_eval(mdl_value_t *l, bool in_struct, mdl_value_t *environment)
 {
+    unsigned char type_flags = MDL_TYPE_FLAGS(l->type);
+    if (!environment)
+    {
+        if (type_flags & MDL_TYPE_FLAG_SELF_EVAL)
+        {
+            return l;
+        }
+        if (!(type_flags & MDL_TYPE_FLAG_EVALTYPE))
+        {
+            return mdl_std_eval(l, in_struct, l->type);
+        }
+    }
+
     mdl_frame_t *save_frame = cur_frame;
     mdl_value_t *result = nullptr;
     if (environment)
     {
         cur_frame = environment->v.f;
-        NEW_BINDID(cur_process_bindid);
     }
 
     int eval_as_type = l->type;
@@ -3307,16 +4137,25 @@ mdl_value_t *mdl_eval(mdl_value_t *l, bool in_struct, mdl_value_t *environment)
     if (environment)
     {
         cur_frame = save_frame;
-        NEW_BINDID(cur_process_bindid);
     }
     return result;
 }
 
 mdl_value_t *mdl_set_gval(atom_t *a, mdl_value_t *val)
 {
-    mdl_symbol_t *symbol = &global_syms[a];
+    mdl_symbol_t *symbol = a->global;
+    if (!symbol)
+    {
+        symbol = a->global = GC_NEW(mdl_symbol_t);
+        symbol->atom = a;
+        global_syms.push_back(a);
+    }
+    // only bindings which might be in the call-site cache matter
+    if (symbol->binding && mdl_type_is_cached_applier(symbol->binding->type))
+    {
+        MDL_BUMP_GLOBAL_EPOCH();
+    }
     symbol->binding = val;
-    symbol->atom = a;
     return val;
 }
 
@@ -3343,6 +4182,8 @@ void mdl_interp_init()
     static_assert(sizeof(MDL_FLOAT) == sizeof(MDL_INT), "sizeof(MDL_FLOAT) != sizeof(MDL_INT)");
 
     srand48(1);
+    mdl_init_stack_limits();
+    mdl_init_small_words();
     mdl_assoc_table = mdl_create_assoc_table();
 
     // must initialize root oblist before the built-in types
@@ -3353,28 +4194,20 @@ void mdl_interp_init()
 
     mdl_create_builtins();
     mdl_init_built_in_types();
+    mdl_rebuild_type_flags();
 
     mdl_value_oblist = mdl_get_atom_from_oblist("OBLIST", mdl_value_root_oblist);
     atom_oblist = mdl_value_oblist->v.a;
 
     // MUDDLE!- is the version number of MUDDLE.  101 is a lie
-    mdl_value_t *muddle = mdl_value_T = mdl_create_atom_on_oblist("MUDDLE", mdl_value_root_oblist);
+    mdl_value_t *muddle = mdl_create_atom_on_oblist("MUDDLE", mdl_value_root_oblist);
     mdl_set_gval(muddle->v.a, mdl_new_fix(101));
 
 
-    mdl_value_T = mdl_create_atom_on_oblist("T", mdl_value_root_oblist);
-
-
-    mdl_value_atom_redefine = mdl_create_atom_on_oblist("REDEFINE", mdl_value_root_oblist);
-    mdl_value_atom_default = mdl_create_atom_on_oblist("DEFAULT", mdl_value_root_oblist);
-    mdl_create_atom_on_oblist("OPT", mdl_value_root_oblist); // for DECL checking
-    mdl_create_atom_on_oblist("COMMENT", mdl_value_root_oblist);
-
     mdl_value_t *mdl_value_atom_interrupts = mdl_create_atom_on_oblist("INTERRUPTS", mdl_value_root_oblist);
     mdl_value_t *iobl = mdl_create_oblist(mdl_value_atom_interrupts, MDL_OBLIST_HASHBUCKET_DEFAULT);
 
-    mdl_value_atom_lastprog = mdl_create_atom_on_oblist("LPROG ", iobl);
-    mdl_value_atom_lastmap = mdl_create_atom_on_oblist("LMAP ", iobl);
+    mdl_find_known_atoms(mdl_value_root_oblist, iobl);
 
     mdl_value_t *atomval_initial = mdl_create_atom_on_oblist("INITIAL", mdl_value_root_oblist);
     // ROOT already exists on ROOT because it's a SUBR
@@ -3385,10 +4218,8 @@ void mdl_interp_init()
     mdl_internal_eval_putprop(atomval_initial, mdl_value_oblist, mdl_value_initial_oblist);
     mdl_internal_eval_putprop(atomval_root, mdl_value_oblist, mdl_value_root_oblist);
 
-    cur_process_bindid = 1;
-
     initial_frame = mdl_new_frame();
-    initial_frame->subr = mdl_get_atom("TOPLEVEL!-", true, nullptr);
+    initial_frame->subr = mdl_value_atom_toplevel;
     initial_frame->frame_flags = MDL_FRAME_FLAGS_TRUEFRAME;
 
     mdl_value_t *dotoblist = mdl_additem(nullptr, mdl_value_initial_oblist);
@@ -3401,9 +4232,6 @@ void mdl_interp_init()
     mdl_set_gval(atom_oblist, commaoblist);
 
     // initialize channels
-    mdl_value_t *mdl_value_atom_inchan = mdl_create_atom_on_oblist("INCHAN", mdl_value_root_oblist);
-    mdl_value_t *mdl_value_atom_outchan = mdl_create_atom_on_oblist("OUTCHAN", mdl_value_root_oblist);
-
     mdl_value_t *def_inchan = mdl_create_default_inchan();
     mdl_set_lval(mdl_value_atom_inchan->v.a, def_inchan, initial_frame);
     mdl_set_gval(mdl_value_atom_inchan->v.a, def_inchan);
@@ -3640,8 +4468,7 @@ mdl_value_t *mdl_internal_eval_nth_i(mdl_value_t *arg, int index)
         {
             return mdl_call_error("ARGUMENT-OUT-OF-RANGE", nullptr);
         }
-        result = mdl_new_fix((int)arg->v.s.p[index - 1]);
-        result->type = MDL_TYPE_CHARACTER;
+        result = mdl_new_word(arg->v.s.p[index - 1], MDL_TYPE_CHARACTER);
         break;
     case PRIMTYPE_VECTOR:
         if (index > VLENGTH(arg))
@@ -3834,6 +4661,7 @@ mdl_value_t *mdl_internal_eval_put(mdl_value_t *arg, mdl_value_t *indexval, mdl_
         {
             mdl_error("PUT index too large");
         }
+        mdl_code_cell_changed(tail);
         tail->v.p.car = newitem;
         break;
 
@@ -3899,22 +4727,42 @@ mdl_value_t *mdl_internal_eval_put(mdl_value_t *arg, mdl_value_t *indexval, mdl_
     return arg;
 }
 
-mdl_value_t *mdl_internal_eval_putprop(mdl_value_t *item, mdl_value_t *indicator, mdl_value_t *val)
+// the reader keeps the COMMENTs it attaches to lists and channels
+// itself, see mdl_set_read_comment
+static bool mdl_is_read_comment(const mdl_value_t *item, const mdl_value_t *indicator)
+{
+    return indicator->type == MDL_TYPE_ATOM && mdl_value_atom_comment &&
+        indicator->v.a == mdl_value_atom_comment->v.a &&
+        mdl_read_comment_applies(item);
+}
+
+mdl_value_t *mdl_internal_eval_putprop(mdl_value_t *item, mdl_value_t *indicator, mdl_value_t *val, bool strong)
 {
+    // a COMMENT put by the program replaces the reader's, and is an
+    // association like any other property
+    if (mdl_is_read_comment(item, indicator))
+    {
+        mdl_set_read_comment(item, nullptr);
+    }
     if (val == nullptr)
     {
         mdl_delete_assoc(mdl_assoc_table, { item, indicator });
     }
     else
     {
-        mdl_add_assoc(mdl_assoc_table, { item, indicator }, val);
+        mdl_add_assoc(mdl_assoc_table, { item, indicator }, val, strong);
     }
     return item;
 }
 
 mdl_value_t *mdl_internal_eval_getprop(mdl_value_t *item, mdl_value_t *indicator)
 {
-    return mdl_assoc_find_value(mdl_assoc_table, { item, indicator });
+    mdl_value_t *result = mdl_assoc_find_value(mdl_assoc_table, { item, indicator });
+    if (!result && mdl_is_read_comment(item, indicator))
+    {
+        result = mdl_get_read_comment(item);
+    }
+    return result;
 }
 
 mdl_value_t *mdl_internal_eval_mapfr(mdl_value_t *form, mdl_value_t *args, bool is_mapr)
@@ -3940,6 +4788,8 @@ mdl_value_t *mdl_internal_eval_mapfr(mdl_value_t *form, mdl_value_t *args, bool
     mdl_value_t *act = mdl_make_frame_value(frame, MDL_TYPE_ACTIVATION);
     mdl_bind_local_symbol(mdl_value_atom_lastmap->v.a, act, frame, false);
     frame->frame_flags = MDL_FRAME_FLAGS_ACTIVATION;
+    jmp_buf jump;
+    frame->interp_frame = &jump;
     mdl_push_frame(frame);
 
     bool hasfinal = mdl_is_true(finalf);
@@ -3990,7 +4840,9 @@ mdl_value_t *mdl_internal_eval_mapfr(mdl_value_t *form, mdl_value_t *args, bool
         if (!done)
         {
             rlist = mdl_make_list(rlist, MDL_TYPE_FORM);
-            int jumpval = mdl_setjmp(frame->interp_frame);
+            size_t argtop = mdl_argstack_top;
+            int jumpval = mdl_setjmp(jump);
+            mdl_argstack_top = argtop;
             switch (jumpval)
             {
             case 0: // normal case
@@ -4040,7 +4892,7 @@ mdl_value_t *mdl_internal_eval_mapfr(mdl_value_t *form, mdl_value_t *args, bool
         if (hasfinal)
         {
             flist = mdl_make_list(flist, MDL_TYPE_FORM);
-            int jumpval = mdl_setjmp(frame->interp_frame);
+            int jumpval = mdl_setjmp(jump);
             if (jumpval)
             {
                 mdl_error("Error Longjmp in finalf");
@@ -4076,7 +4928,7 @@ mdl_value_t *mdl_internal_listen_error(mdl_value_t *args, bool is_error)
     }
     mdl_bind_local_symbol(atom_oblist, oblists, cur_frame, false);
 
-    mdl_value_t *atom_inchan = mdl_get_atom("INCHAN!-", true, nullptr);
+    mdl_value_t *atom_inchan = mdl_value_atom_inchan;
     mdl_value_t *inchan = mdl_local_symbol_lookup(atom_inchan->v.a, cur_frame);
     if (!mdl_inchan_is_reasonable(inchan))
     {
@@ -4090,7 +4942,7 @@ mdl_value_t *mdl_internal_listen_error(mdl_value_t *args, bool is_error)
     }
     mdl_bind_local_symbol(atom_inchan->v.a, inchan, cur_frame, false);
 
-    mdl_value_t *atom_outchan = mdl_get_atom("OUTCHAN!-", true, nullptr);
+    mdl_value_t *atom_outchan = mdl_value_atom_outchan;
     mdl_value_t *outchan = mdl_local_symbol_lookup(atom_outchan->v.a, cur_frame);
     if (!mdl_outchan_is_reasonable(outchan))
     {
@@ -4105,7 +4957,7 @@ mdl_value_t *mdl_internal_listen_error(mdl_value_t *args, bool is_error)
     mdl_bind_local_symbol(atom_outchan->v.a, outchan, cur_frame, false);
     int printflags = mdl_chan_mode_is_print_binary(outchan) ? MDL_PF_BINARY : 0;
 
-    mdl_value_t *atom_l_level = mdl_get_atom("L-LEVEL !-INTERRUPTS!-", true, nullptr);
+    mdl_value_t *atom_l_level = mdl_value_atom_l_level;
     mdl_value_t *l_level = mdl_local_symbol_lookup(atom_l_level->v.a, cur_frame);
     if (!l_level || l_level->type != MDL_TYPE_FIX)
     {
@@ -4117,7 +4969,7 @@ mdl_value_t *mdl_internal_listen_error(mdl_value_t *args, bool is_error)
     }
     mdl_bind_local_symbol(atom_l_level->v.a, l_level, cur_frame, false);
 
-    mdl_value_t *atom_lerr = mdl_get_atom("L-ERR !-INTERRUPTS!-", true, nullptr);
+    mdl_value_t *atom_lerr = mdl_value_atom_l_err;
     mdl_bind_local_symbol(atom_lerr->v.a, mdl_make_frame_value(cur_frame), cur_frame, false);
     if (is_error)
     {
@@ -4138,7 +4990,7 @@ mdl_value_t *mdl_internal_listen_error(mdl_value_t *args, bool is_error)
             args = args->v.p.cdr;
         }
 
-        mdl_value_t *atom_intlevel = mdl_get_atom("INT-LEVEL!-INTERRUPTS!-", true, nullptr);
+        mdl_value_t *atom_intlevel = mdl_value_atom_int_level;
         mdl_value_t *intlevel = mdl_global_symbol_lookup(atom_intlevel->v.a);
 
         mdl_print_newline_to_chan(outchan, printflags, nullptr);
@@ -4155,7 +5007,13 @@ mdl_value_t *mdl_internal_listen_error(mdl_value_t *args, bool is_error)
     }
     suppress_listen_message = false;
 
-    int jumpval = mdl_setjmp(cur_frame->interp_frame);
+    // LISTEN is its own jump target, so its frame needs the jmp_buf
+    cur_frame->frame_flags &= ~MDL_FRAME_FLAGS_CATCH;
+    jmp_buf jump;
+    cur_frame->interp_frame = &jump;
+    size_t argtop = mdl_argstack_top;
+    int jumpval = mdl_setjmp(jump);
+    mdl_argstack_top = argtop;
 
     if (jumpval == 0)
     {
@@ -4198,7 +5056,10 @@ void mdl_toplevel(std::FILE *restorefile)
     cur_frame = initial_frame;
     cur_frame->frame_flags |= MDL_FRAME_FLAGS_TRUEFRAME;
     cur_frame->args = mdl_make_list(nullptr);
-    int jumpval = mdl_setjmp(cur_frame->interp_frame);
+    jmp_buf jump;
+    cur_frame->interp_frame = &jump;
+    int jumpval = mdl_setjmp(jump);
+    mdl_argstack_top = 0;
     if (restorefile && !jumpval)
     {
         mdl_read_image(restorefile);
@@ -4206,7 +5067,7 @@ void mdl_toplevel(std::FILE *restorefile)
         exit(-1);
     }
     // re-acquire the atom in case of restore
-    cur_frame->subr = mdl_get_atom("TOPLEVEL!-", true, nullptr);
+    cur_frame->subr = mdl_value_atom_toplevel;
     suppress_listen_message = jumpval == LONGJMP_RESTORE;
     if (jumpval == LONGJMP_RESTORE && cur_frame->result)
     {
@@ -4217,6 +5078,7 @@ void mdl_toplevel(std::FILE *restorefile)
     {
         mdl_std_apply(mdl_value_builtin_listen, mdl_make_list(mdl_cons_internal(mdl_value_builtin_listen, nullptr)), MDL_TYPE_SUBR, true);
     }
+    initial_frame->interp_frame = nullptr;
     cur_frame = nullptr;
 }
 
@@ -4226,7 +5088,7 @@ void mdl_internal_erret(mdl_value_t *result, mdl_value_t *frame)
     {
         if (!frame)
         {
-            frame = mdl_local_symbol_lookup_pname("L-ERR !-INTERRUPTS!-", cur_frame);
+            frame = mdl_local_symbol_lookup(mdl_value_atom_l_err->v.a, cur_frame);
         }
         if (!frame)
         {
@@ -5097,6 +5959,7 @@ mdl_value_t *mdl_builtin_eval_substruc(mdl_value_t *form, mdl_value_t *args)
                 {
                     return mdl_call_error_ext("ARGUMENT-OUT-OF-RANGE", "SUBSTRUC destination too short", nullptr);
                 }
+                mdl_code_cell_changed(cursor);
                 cursor->v.p.car = start->v.p.car;
                 cursor = cursor->v.p.cdr;
                 start = start->v.p.cdr;
@@ -5516,6 +6379,7 @@ mdl_value_t *mdl_builtin_eval_putrest(mdl_value_t *form, mdl_value_t *args)
     {
         mdl_error("Can't PUTREST on an empty list");
     }
+    mdl_code_cell_changed(head->v.p.cdr);
     head->v.p.cdr->v.p.cdr = tail->v.p.cdr;
     return head;
 }
@@ -6030,9 +6894,7 @@ mdl_value_t *mdl_builtin_eval_ascii(mdl_value_t *form, mdl_value_t *args)
 
     if (forc->type == MDL_TYPE_CHARACTER)
     {
-        result = mdl_new_mdl_value();
-        *result = *forc;
-        result->type = MDL_TYPE_FIX;
+        result = mdl_new_fix(forc->v.w);
     }
     else if (forc->type == MDL_TYPE_FIX)
     {
@@ -6040,9 +6902,7 @@ mdl_value_t *mdl_builtin_eval_ascii(mdl_value_t *form, mdl_value_t *args)
         {
             mdl_error("Value for ASCII out of range");
         }
-        result = mdl_new_mdl_value();
-        *result = *forc;
-        result->type = MDL_TYPE_CHARACTER;
+        result = mdl_new_word(forc->v.w, MDL_TYPE_CHARACTER);
     }
     else
     {
@@ -6098,12 +6958,10 @@ mdl_value_t *mdl_builtin_eval_parse(mdl_value_t *form, mdl_value_t *args)
     }
     if (parse_string)
     {
-        mdl_value_t *mdl_value_atom_parse_string = mdl_get_atom("PARSE-STRING!-", true, nullptr);
         mdl_bind_local_symbol(mdl_value_atom_parse_string->v.a, parse_string, cur_frame, false);
     }
     if (parse_table)
     {
-        mdl_value_t *mdl_value_atom_parse_table = mdl_get_atom("PARSE-TABLE!-", true, nullptr);
         mdl_bind_local_symbol(mdl_value_atom_parse_table->v.a, parse_table, cur_frame, false);
     }
 
@@ -6138,7 +6996,6 @@ mdl_value_t *mdl_builtin_eval_unparse(mdl_value_t *form, mdl_value_t *args)
     }
 
     mdl_value_t *chan = mdl_create_internal_output_channel(INTERNAL_BUFSIZE, 0, nullptr);
-    mdl_value_t *mdl_value_atom_outchan = mdl_get_atom("OUTCHAN!-", true, nullptr);
     mdl_bind_local_symbol(mdl_value_atom_outchan->v.a, chan, cur_frame, false);
 
     mdl_print_value_to_chan(chan, obj, false, false, nullptr);
@@ -6251,7 +7108,7 @@ mdl_value_t *mdl_builtin_eval_apply(mdl_value_t *form, mdl_value_t *args)
 
     GETNEXTREQARG(applier, args);
 
-    return mdl_internal_apply(applier, args, true);
+    return mdl_internal_apply(applier, mdl_argstack_copy_list(args), true);
 }
 
 // LOOPING - PROG, REPEAT, BIND, RETURN, AGAIN
@@ -6276,16 +7133,13 @@ mdl_value_t *mdl_builtin_eval_again(mdl_value_t *form, mdl_value_t *args)
     GETNEXTARG(act, args);
     NOMOREARGS(args);
 
-    if (!act)
-    {
-        act = mdl_local_symbol_lookup_1_activation_only_please(mdl_value_atom_lastprog->v.a, cur_frame);
-    }
-    if (!act)
+    mdl_frame_t *target = act ? act->v.f : mdl_lastprog_frame(cur_frame);
+    if (!target)
     {
         mdl_error("No activation in AGAIN");
     }
 
-    mdl_longjmp_to(act->v.f, LONGJMP_AGAIN);
+    mdl_longjmp_to(target, LONGJMP_AGAIN);
 }
 
 mdl_value_t *mdl_builtin_eval_return(mdl_value_t *form, mdl_value_t *args)
@@ -6303,17 +7157,14 @@ mdl_value_t *mdl_builtin_eval_return(mdl_value_t *form, mdl_value_t *args)
     {
         val = mdl_value_T;
     }
-    if (!act)
-    {
-        act = mdl_local_symbol_lookup_1_activation_only_please(mdl_value_atom_lastprog->v.a, cur_frame);
-    }
-    if (!act)
+    mdl_frame_t *target = act ? act->v.f : mdl_lastprog_frame(cur_frame);
+    if (!target)
     {
         mdl_error("No activation in RETURN");
     }
 
-    act->v.f->result = val;
-    mdl_longjmp_to(act->v.f, LONGJMP_RETURN);
+    target->result = val;
+    mdl_longjmp_to(target, LONGJMP_RETURN);
 }
 
 mdl_value_t *mdl_builtin_eval_prog(mdl_value_t *form, mdl_value_t *args)
@@ -6344,7 +7195,7 @@ mdl_value_t *mdl_builtin_eval_mapret(mdl_value_t *form, mdl_value_t *args)
         mdl_error("No map in MAPRET");
     }
 
-    act->v.f->result = args;
+    act->v.f->result = mdl_argstack_copy_list(args);
     mdl_longjmp_to(act->v.f, LONGJMP_MAPRET);
 }
 
@@ -6357,7 +7208,7 @@ mdl_value_t *mdl_builtin_eval_mapstop(mdl_value_t *form, mdl_value_t *args)
         mdl_error("No map in MAPSTOP");
     }
 
-    act->v.f->result = args;
+    act->v.f->result = mdl_argstack_copy_list(args);
     mdl_longjmp_to(act->v.f, LONGJMP_MAPSTOP);
 }
 
@@ -7260,6 +8111,26 @@ mdl_value_t *mdl_builtin_eval_putprop(mdl_value_t *form, mdl_value_t *args)
     return result;
 }
 
+// PUTPROP, but the association keeps its item and indicator from being
+// collected, and the collector needn't watch them.  For properties of
+// objects that last as long as the program does
+mdl_value_t *mdl_builtin_eval_putprop_strong(mdl_value_t *form, mdl_value_t *args)
+/* SUBR PUTPROP-STRONG */
+{
+    mdl_value_t *item = LITEM(args, 0);
+    mdl_value_t *indicator = LITEM(args, 1);
+    mdl_value_t *value = LITEM(args, 2);
+    if (value == nullptr)
+    {
+        mdl_error("Not enough ARGS in PUTPROP-STRONG");
+    }
+    if (LHASITEM(args, 3))
+    {
+        mdl_error("Too many ARGS in PUTPROP-STRONG");
+    }
+    return mdl_internal_eval_putprop(item, indicator, value, true);
+}
+
 // Object lists
 mdl_value_t *mdl_builtin_eval_moblist(mdl_value_t *form, mdl_value_t *args)
 /* SUBR */
@@ -7282,6 +8153,7 @@ mdl_value_t *mdl_builtin_eval_moblist(mdl_value_t *form, mdl_value_t *args)
     {
         mdl_error("First argument to MOBLIST must be atom");
     }
+    // only the starting size; the oblist grows as atoms are added
     MDL_INT buckets = MDL_OBLIST_HASHBUCKET_DEFAULT;
     if (fix)
     {
@@ -7376,7 +8248,7 @@ mdl_value_t *mdl_builtin_eval_remove(mdl_value_t *form, mdl_value_t *args)
         {
             mdl_error("Too many arguments to REMOVE (atom)");
         }
-        result = mdl_remove_atom_from_oblist(str->v.a->pname, str->v.a->oblist);
+        result = mdl_remove_atom_from_oblist(str->v.a->pname, str->v.a->hash, str->v.a->oblist);
     }
     else
     {
@@ -7396,7 +8268,7 @@ mdl_value_t *mdl_builtin_eval_remove(mdl_value_t *form, mdl_value_t *args)
         {
             mdl_error("Second argument to REMOVE must be oblist");
         }
-        result = mdl_remove_atom_from_oblist(str->v.s.p, oblist);
+        result = mdl_remove_atom_from_oblist(str->v.s.p, mdl_hash_pname(str->v.s.p), oblist);
     }
     if (result) return result;
     return &mdl_value_false;
@@ -7427,11 +8299,11 @@ mdl_value_t *mdl_builtin_eval_insert(mdl_value_t *form, mdl_value_t *args)
         {
             return mdl_call_error_ext("ATOM-ALREADY-THERE", "Cannot INSERT, atom already on plist", str, mdl_internal_eval_getprop(oblist, mdl_value_oblist), nullptr);
         }
-        if (mdl_get_atom_from_oblist(str->v.a->pname, oblist))
+        if (mdl_get_atom_from_oblist(str->v.a->pname, str->v.a->hash, oblist))
         {
             return mdl_call_error_ext("ATOM-ALREADY-THERE", "Cannot INSERT, atom with same pname exists on oblist", str, mdl_internal_eval_getprop(oblist, mdl_value_oblist), nullptr);
         }
-        mdl_put_atom_in_oblist(str->v.a->pname, oblist, str);
+        mdl_put_atom_in_oblist(oblist, str);
         str->v.a->oblist = oblist;
         result = str;
     }
@@ -7991,10 +8863,9 @@ mdl_value_t *mdl_builtin_eval_access(mdl_value_t *form, mdl_value_t *args)
 // Conversion I/O
 void mdl_setup_frame_for_read(mdl_value_t **chanp, mdl_value_t *look_up, mdl_value_t *read_table)
 {
-    mdl_value_t *mdl_value_atom_inchan  = mdl_get_atom("INCHAN!-", true, nullptr);
     if (!*chanp)
     {
-        *chanp = mdl_local_symbol_lookup_pname("INCHAN!-", cur_frame);
+        *chanp = mdl_local_symbol_lookup(mdl_value_atom_inchan->v.a, cur_frame);
         if (!*chanp)
         {
             mdl_error("No channel for READ");
@@ -8015,7 +8886,6 @@ void mdl_setup_frame_for_read(mdl_value_t **chanp, mdl_value_t *look_up, mdl_val
 
     if (read_table)
     {
-        mdl_value_t *mdl_value_atom_read_table = mdl_get_atom("READ-TABLE!-", true, nullptr);
 
         mdl_bind_local_symbol(mdl_value_atom_read_table->v.a, read_table, cur_frame, false);
     }
@@ -8094,7 +8964,6 @@ mdl_value_t *mdl_builtin_eval_nextchr(mdl_value_t *form, mdl_value_t *args)
 // Conversion output
 void mdl_setup_frame_for_print(mdl_value_t **chanp)
 {
-    mdl_value_t *mdl_value_atom_outchan  = mdl_get_atom("OUTCHAN!-", true, nullptr);
     if (!*chanp)
     {
         *chanp = mdl_local_symbol_lookup(mdl_value_atom_outchan->v.a, cur_frame);
@@ -8253,11 +9122,12 @@ mdl_value_t *mdl_builtin_eval_flatsize(mdl_value_t *form, mdl_value_t *args)
     mdl_push_frame(frame);
 
     mdl_value_t *chan = mdl_create_internal_output_channel(0, max->v.w, mdl_make_frame_value(frame));
-    mdl_value_t *mdl_value_atom_outchan = mdl_get_atom("OUTCHAN!-", true, nullptr);
     mdl_bind_local_symbol(mdl_value_atom_outchan->v.a, chan, frame, false);
 
+    jmp_buf jump;
+    frame->interp_frame = &jump;
     int jumpval;
-    if ((jumpval = mdl_setjmp(frame->interp_frame)) != 0)
+    if ((jumpval = mdl_setjmp(jump)) != 0)
     {
         if (jumpval == LONGJMP_FLATSIZE_EXCEEDED)
         {
@@ -8507,6 +9377,7 @@ mdl_value_t *mdl_builtin_eval_fload(mdl_value_t *form, mdl_value_t *args)
     {
         mdl_error("Couldn't open file in FLOAD"); // FIXME by passing FALSE to ERROR
     }
+    mdl_set_chan_keeps_comments(chan, mdl_fload_keeps_comments);
 
     // frame for fake UNWIND
     mdl_frame_t *prev_frame = cur_frame;
@@ -8515,15 +9386,17 @@ mdl_value_t *mdl_builtin_eval_fload(mdl_value_t *form, mdl_value_t *args)
     cur_frame->prev_frame = prev_frame;
     mdl_setup_frame_for_read(&chan, look_up, nullptr);
     cur_frame->args = mdl_new_empty_tuple(2, MDL_TYPE_TUPLE);
-    cur_frame->frame_flags = MDL_FRAME_FLAGS_UNWIND;
+    cur_frame->frame_flags |= MDL_FRAME_FLAGS_UNWIND;
 
     mdl_value_t *close_form = mdl_cons_internal(chan, nullptr);
-    close_form = mdl_cons_internal(mdl_get_atom_from_oblist("CLOSE", mdl_value_root_oblist), close_form);
+    close_form = mdl_cons_internal(mdl_value_atom_close, close_form);
     close_form = mdl_make_list(close_form, MDL_TYPE_FORM);
     *TPREST(cur_frame->args, 1) = *close_form;
 
+    jmp_buf jump;
+    cur_frame->interp_frame = &jump;
     int jumpval;
-    if ((jumpval = mdl_setjmp(cur_frame->interp_frame) != 0))
+    if ((jumpval = mdl_setjmp(jump) != 0))
     {
         // Pass it up the chain
         mdl_longjmp_to(prev_frame, jumpval);
@@ -8784,7 +9657,7 @@ mdl_value_t *mdl_builtin_eval_retry(mdl_value_t *form, mdl_value_t *args)
 
     if (!frame)
     {
-        frame = mdl_local_symbol_lookup_pname("L-ERR !-INTERRUPTS!-", cur_frame);
+        frame = mdl_local_symbol_lookup(mdl_value_atom_l_err->v.a, cur_frame);
     }
     if (!frame)
     {
@@ -8868,7 +9741,7 @@ mdl_value_t *mdl_builtin_eval_frame(mdl_value_t *form, mdl_value_t *args)
 
     if (!frame)
     {
-        frame = mdl_local_symbol_lookup_pname("L-ERR !-INTERRUPTS!-", cur_frame);
+        frame = mdl_local_symbol_lookup(mdl_value_atom_l_err->v.a, cur_frame);
     }
     if (!frame)
     {
@@ -8904,7 +9777,7 @@ mdl_value_t *mdl_builtin_eval_fframe(mdl_value_t *form, mdl_value_t *args)
 
     if (!frame)
     {
-        frame = mdl_local_symbol_lookup_pname("L-ERR !-INTERRUPTS!-", cur_frame);
+        frame = mdl_local_symbol_lookup(mdl_value_atom_l_err->v.a, cur_frame);
     }
     if (!frame)
     {
@@ -8955,9 +9828,6 @@ mdl_value_t *mdl_builtin_eval_rep(mdl_value_t *form, mdl_value_t *args)
 
     mdl_value_t *dummy = mdl_new_fix(69152);
 
-    mdl_value_t *mdl_value_atom_read = mdl_get_atom_from_oblist("READ", mdl_value_root_oblist);
-    mdl_value_t *mdl_value_atom_terpri = mdl_get_atom_from_oblist("TERPRI", mdl_value_root_oblist);
-    mdl_value_t *mdl_value_atom_print = mdl_get_atom_from_oblist("PRINT", mdl_value_root_oblist);
     mdl_value_t *readform = mdl_make_list(mdl_cons_internal(mdl_value_atom_read, nullptr));
     mdl_value_t *terpriform = mdl_make_list(mdl_cons_internal(mdl_value_atom_terpri, nullptr));
     mdl_value_t *noargs = mdl_make_list(nullptr);
@@ -8966,7 +9836,7 @@ mdl_value_t *mdl_builtin_eval_rep(mdl_value_t *form, mdl_value_t *args)
     printform = mdl_make_list(printform);
     mdl_value_t *printargs = mdl_cons_internal(dummy, nullptr);
     printargs = mdl_make_list(printargs);
-    atom_t *atom_last_out = mdl_get_atom("LAST-OUT!-", true, nullptr)->v.a;
+    atom_t *atom_last_out = mdl_value_atom_last_out->v.a;
 
     mdl_value_t *evalresult;
 // ZORK's behavior implies this while loop is not here,
@@ -9498,7 +10368,7 @@ mdl_value_t *mdl_builtin_eval_int_level(mdl_value_t *form, mdl_value_t *args)
         mdl_error("INT-LEVEL argument must be FIX");
     }
 
-    mdl_value_t *atom_intlevel = mdl_get_atom("INT-LEVEL!-INTERRUPTS!-", true, nullptr);
+    mdl_value_t *atom_intlevel = mdl_value_atom_int_level;
     mdl_value_t *result = mdl_global_symbol_lookup(atom_intlevel->v.a);
     if (!result)
     {
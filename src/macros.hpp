@@ -25,6 +25,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <cfloat>
 #include <csetjmp>
 #include <cstdint>
@@ -178,6 +179,7 @@ struct atom_t;
 //*************************************
 mdl_value_t *mdl_create_or_get_atom(const char *pname);
 mdl_value_t *mdl_new_word(MDL_INT fix, int type);
+bool mdl_is_shared_word(const mdl_value_t *v);
 mdl_value_t *mdl_new_float(MDL_FLOAT flt);
 mdl_value_t *mdl_new_string(const char *string);
 mdl_value_t *mdl_newatomval(atom_t *a);
@@ -194,6 +196,8 @@ mdl_value_t *mdl_make_tuple(mdl_value_t *a, int type = MDL_TYPE_TUPLE, bool dest
 void mdl_print_atom(std::FILE *f, const atom_t *a);
 void mdl_print_value(std::FILE *f, mdl_value_t *v);
 void mdl_interp_init();
+void mdl_set_max_frame_depth(unsigned depth);
+void mdl_set_fload_comments(bool keep);
 
 mdl_value_t *mdl_eval(mdl_value_t *l, bool in_struct = false, mdl_value_t *environment = nullptr);
 int mdl_get_typenum(mdl_value_t *val);
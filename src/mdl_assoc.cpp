@@ -16,10 +16,11 @@
 /*****************************************************************************/
 #include <gc/gc.h>
 
+#include <algorithm>
+#include <climits>
+#include <cstdint>
 #include <cstring>
 
-#include <unistd.h>
-
 #include "macros.hpp"
 #include "mdl_assoc.hpp"
 #include "mdl_internal_defs.h"
@@ -29,8 +30,31 @@
 // rather than futz with typed objects, I simply hold the key in a separately
 // allocated structure
 
-//#define MDL_ASSOC_NBUCKETS 101 // same as what SGI uses as STL default (first prime >= 100)
-#define MDL_ASSOC_NBUCKETS 293
+// The table starts with MDL_ASSOC_MIN_SLOTS slots.  Whenever half its
+// slots are in use (deleted ones count), it is rehashed into the
+// smallest power of two that is at least four times its live
+// associations, so it starts out no more than a quarter full
+#define MDL_ASSOC_MIN_SLOTS 512
+// slots swept for dead associations per lookup, after a collection
+#define MDL_ASSOC_CLEAN_STEP 16
+#define MDL_ASSOC_ATOM_CHUNK 256
+#define MDL_ATOM_PROPS_MIN 4
+
+// Most properties are an ATOM's under an ATOM indicator, like an object's
+// DESC or FLAGS.  Those are kept in the item atom's props, which need
+// neither a key nor disappearing links: they go when the atom goes, and
+// an atom indicator is as good as permanent.  The table records the
+// atoms it gave properties to, so it can walk and clear them; the
+// records are in atomic chunks, so they don't keep the atoms alive, and
+// exists is cleared when the atom is collected
+struct mdl_assoc_atom_t
+{
+    atom_t *atom;
+    void *exists;
+};
+
+// marks a slot whose association was deleted, so probes go on past it
+static mdl_assoc_t mdl_assoc_deleted;
 
 inline
 bool mdl_assoc_key_equals(const mdl_assoc_key_t &a, const mdl_assoc_key_t &b)
@@ -39,196 +63,521 @@ bool mdl_assoc_key_equals(const mdl_assoc_key_t &a, const mdl_assoc_key_t &b)
            mdl_value_double_equal(a.indicator, b.indicator);
 }
 
+// an association whose item or indicator has been collected can't be
+// found, since there's nothing left to look it up by
+inline
+bool mdl_assoc_is_live(const mdl_assoc_t *assoc)
+{
+    return assoc->item_exists && assoc->indicator_exists;
+}
+
+// Values hash to addresses, whose low bits are mostly zero, so the two
+// are mixed thoroughly (the 64-bit finalizer from MurmurHash3) before
+// the low bits pick a slot
 static size_t mdl_hash_assoc_key(const mdl_assoc_key_t &h)
 {
-    size_t hitem = mdl_hash_value(h.item);
-    size_t hindic = mdl_hash_value(h.indicator);
-    size_t tmp;
-    swab(&hindic, &tmp, sizeof(size_t));
-//    std::printf("Hash: %lx %lx %lx %lx\n", hitem, hindic, tmp, hitem + tmp);
-    return hitem + tmp;
+    uint64_t hash = (uint64_t)mdl_hash_value(h.item) * 0x9E3779B97F4A7C15ULL;
+    hash ^= (uint64_t)mdl_hash_value(h.indicator);
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return (size_t)hash;
+}
+
+inline
+bool mdl_assoc_key_on_atom(const mdl_assoc_key_t &key)
+{
+    return key.item->type == MDL_TYPE_ATOM && key.indicator->type == MDL_TYPE_ATOM;
+}
+
+static mdl_assoc_atom_t *mdl_assoc_atom_record(mdl_assoc_table_t *table, int i)
+{
+    return &table->atom_chunks[i / MDL_ASSOC_ATOM_CHUNK][i % MDL_ASSOC_ATOM_CHUNK];
+}
+
+// the props of a record's atom, or nullptr if it has been collected
+static mdl_atom_props_t *mdl_assoc_atom_props(mdl_assoc_table_t *table, int i)
+{
+    mdl_assoc_atom_t *record = mdl_assoc_atom_record(table, i);
+    return record->exists ? record->atom->props : nullptr;
+}
+
+static void mdl_assoc_record_atom(mdl_assoc_table_t *table, atom_t *a)
+{
+    if (table->natoms == table->natom_chunks * MDL_ASSOC_ATOM_CHUNK)
+    {
+        mdl_assoc_atom_t **chunks = (mdl_assoc_atom_t **)GC_MALLOC(sizeof(mdl_assoc_atom_t *) * (table->natom_chunks + 1));
+        std::copy(table->atom_chunks, table->atom_chunks + table->natom_chunks, chunks);
+        chunks[table->natom_chunks++] = (mdl_assoc_atom_t *)GC_MALLOC_ATOMIC(sizeof(mdl_assoc_atom_t) * MDL_ASSOC_ATOM_CHUNK);
+        table->atom_chunks = chunks;
+    }
+    mdl_assoc_atom_t *record = mdl_assoc_atom_record(table, table->natoms++);
+    record->atom = a;
+    record->exists = (void *)1;
+    GC_GENERAL_REGISTER_DISAPPEARING_LINK(&record->exists, a);
+}
+
+static mdl_atom_prop_t *mdl_find_atom_prop(const mdl_assoc_key_t &inkey)
+{
+    mdl_atom_props_t *props = inkey.item->v.a->props;
+    if (props)
+    {
+        const atom_t *indicator = inkey.indicator->v.a;
+        for (int i = 0; i < props->nprops; i++)
+        {
+            if (props->props[i].key.indicator->v.a == indicator)
+            {
+                return &props->props[i];
+            }
+        }
+    }
+    return nullptr;
+}
+
+static mdl_atom_props_t *mdl_new_atom_props(int maxprops)
+{
+    mdl_atom_props_t *props = (mdl_atom_props_t *)GC_MALLOC(sizeof(mdl_atom_props_t) + sizeof(mdl_atom_prop_t) * (maxprops - 1));
+    props->maxprops = maxprops;
+    return props;
+}
+
+static void mdl_add_atom_prop(mdl_assoc_table_t *table, const mdl_assoc_key_t &inkey, mdl_value_t *value)
+{
+    atom_t *a = inkey.item->v.a;
+    mdl_atom_props_t *props = a->props;
+    if (!props)
+    {
+        props = mdl_new_atom_props(MDL_ATOM_PROPS_MIN);
+        mdl_assoc_record_atom(table, a);
+    }
+    else if (props->nprops == props->maxprops)
+    {
+        props = mdl_new_atom_props(props->maxprops * 2);
+        props->nprops = a->props->nprops;
+        std::copy(a->props->props, a->props->props + props->nprops, props->props);
+    }
+    a->props = props;
+    props->props[props->nprops].key = inkey;
+    props->props[props->nprops].value = value;
+    props->nprops++;
+    table->natom_props++;
+}
+
+static void mdl_delete_atom_prop(mdl_assoc_table_t *table, mdl_atom_props_t *props, int i)
+{
+    std::copy(props->props + i + 1, props->props + props->nprops, props->props + i);
+    props->nprops--;
+    props->props[props->nprops] = mdl_atom_prop_t();
+    table->natom_props--;
+}
+
+// An ATOM on an oblist isn't going anywhere, so an association doesn't
+// need a disappearing link to notice it go; holding it strongly costs
+// nothing, and saves the collector looking at the link every time.
+// REMOVE undoes it, see mdl_assoc_atom_removed.  A shared small FIX or
+// CHARACTER is never collected either, and can't have a link at all,
+// being inside a table rather than an object of its own
+inline
+bool mdl_assoc_value_is_permanent(const mdl_value_t *v)
+{
+    return (v->type == MDL_TYPE_ATOM && v->v.a->oblist) || mdl_is_shared_word(v);
+}
+
+static void mdl_assoc_hold(void **exists, mdl_value_t *v, bool strong)
+{
+    if (strong)
+    {
+        if (*exists == (void *)1)
+        {
+            GC_unregister_disappearing_link(exists);
+        }
+        *exists = v;
+    }
+    else
+    {
+        *exists = (void *)1;
+        GC_GENERAL_REGISTER_DISAPPEARING_LINK(exists, v);
+    }
+}
+
+static mdl_assoc_t **mdl_new_assoc_slots(int nslots)
+{
+    return (mdl_assoc_t **)GC_MALLOC_IGNORE_OFF_PAGE(sizeof(mdl_assoc_t *) * nslots);
 }
 
 mdl_assoc_table_t *
 mdl_create_assoc_table()
 {
-    mdl_assoc_table_t *result = (mdl_assoc_table_t *)GC_MALLOC(sizeof(mdl_assoc_table_t) + sizeof(mdl_assoc_t *) * (MDL_ASSOC_NBUCKETS - 1));
-    result->nbuckets = (MDL_ASSOC_NBUCKETS - 1);
+    mdl_assoc_table_t *result = GC_NEW(mdl_assoc_table_t);
+    result->nslots = MDL_ASSOC_MIN_SLOTS;
+    result->slots = mdl_new_assoc_slots(result->nslots);
     result->last_clean = GC_get_gc_no();
+    result->clean_slot = result->nslots;
     return result;
 }
 
 void mdl_clear_assoc_table(mdl_assoc_table_t *table)
 {
     // Garbage collection does make some things easier...
-    std::memset(table->buckets, 0, sizeof(table->buckets[0]) * table->nbuckets);
+    std::memset(table->slots, 0, sizeof(table->slots[0]) * table->nslots);
     table->last_clean = GC_get_gc_no();
+    table->clean_slot = table->nslots;
     table->size = 0;
+    table->used = 0;
+    for (int i = 0; i < table->natoms; i++)
+    {
+        if (mdl_assoc_atom_props(table, i))
+        {
+            mdl_assoc_atom_record(table, i)->atom->props = nullptr;
+        }
+    }
+    table->natoms = 0;
+    table->natom_chunks = 0;
+    table->atom_chunks = nullptr;
+    table->natom_props = 0;
 }
 
 int mdl_swap_assoc_table(mdl_assoc_table_t *t1, mdl_assoc_table_t *t2)
 {
-    if (t1->nbuckets != t2->nbuckets)
-    {
-        return -1;
-    }
-
-    mdl_assoc_t **t1p = t1->buckets;
-    mdl_assoc_t **t2p = t2->buckets;
-
     using std::swap;
-    for (int i = 0; i < t1->nbuckets; i++)
-    {
-        swap(*t2p, *t1p);
-        ++t1p;
-        ++t2p;
-    }
-
+    swap(t2->nslots, t1->nslots);
+    swap(t2->slots, t1->slots);
     swap(t2->size, t1->size);
+    swap(t2->used, t1->used);
     swap(t2->last_clean, t1->last_clean);
+    swap(t2->clean_slot, t1->clean_slot);
+    swap(t2->natoms, t1->natoms);
+    swap(t2->natom_chunks, t1->natom_chunks);
+    swap(t2->atom_chunks, t1->atom_chunks);
+    swap(t2->natom_props, t1->natom_props);
 
     return 0;
 }
 
-static mdl_assoc_t *mdl_find_assoc(mdl_assoc_table_t *table, const mdl_assoc_key_t &inkey)
+// put the live associations in a new set of slots, the smallest power
+// of two (and at least MDL_ASSOC_MIN_SLOTS) that is at least four times
+// as many as there are associations, dropping the deleted ones
+static void mdl_rehash_assoc_table(mdl_assoc_table_t *table)
 {
-    if (table->last_clean != GC_get_gc_no())
+    int nslots = MDL_ASSOC_MIN_SLOTS;
+    while (nslots < table->size * 4 && nslots < INT_MAX / 2)
     {
-        mdl_assoc_clean(table);
+        nslots *= 2;
     }
-    int bucketnum = mdl_hash_assoc_key(inkey) % table->nbuckets;
-    mdl_assoc_t *cursor = table->buckets[bucketnum];
-    while (cursor)
+    mdl_assoc_t **slots = mdl_new_assoc_slots(nslots);
+    int size = 0;
+    for (int i = 0; i < table->nslots; i++)
     {
-        if (mdl_assoc_key_equals(*cursor->key, inkey))
+        mdl_assoc_t *assoc = table->slots[i];
+        if (!assoc || assoc == &mdl_assoc_deleted || !mdl_assoc_is_live(assoc))
         {
-            return cursor;
+            continue;
         }
-        cursor = cursor->next;
+        size_t slot = assoc->hash & (nslots - 1);
+        while (slots[slot])
+        {
+            slot = (slot + 1) & (nslots - 1);
+        }
+        slots[slot] = assoc;
+        size++;
     }
-    return nullptr;
+    table->nslots = nslots;
+    table->slots = slots;
+    table->size = size;
+    table->used = size;
+    table->clean_slot = nslots;
+}
+
+// Dead associations are removed a few slots at a time: each collection
+// starts a sweep of the table, and each lookup carries it on for
+// MDL_ASSOC_CLEAN_STEP slots, so no one lookup pays for the whole table.
+// Lookups pass over dead associations in the meantime
+static void mdl_assoc_clean_some(mdl_assoc_table_t *table)
+{
+    GC_word gc_no = GC_get_gc_no();
+    if (table->last_clean != gc_no)
+    {
+        table->last_clean = gc_no;
+        table->clean_slot = 0;
+    }
+    int end = std::min(table->clean_slot + MDL_ASSOC_CLEAN_STEP, table->nslots);
+    for (int slot = table->clean_slot; slot < end; slot++)
+    {
+        mdl_assoc_t *assoc = table->slots[slot];
+        if (assoc && assoc != &mdl_assoc_deleted && !mdl_assoc_is_live(assoc))
+        {
+            table->slots[slot] = &mdl_assoc_deleted;
+            table->size--;
+        }
+    }
+    table->clean_slot = end;
+}
+
+// the slot holding the association for inkey, or -1.  Dead
+// associations met on the way are deleted
+static int mdl_find_assoc_slot(mdl_assoc_table_t *table, const mdl_assoc_key_t &inkey, size_t hash)
+{
+    mdl_assoc_clean_some(table);
+    size_t mask = table->nslots - 1;
+    for (size_t slot = hash & mask; table->slots[slot]; slot = (slot + 1) & mask)
+    {
+        mdl_assoc_t *assoc = table->slots[slot];
+        if (assoc == &mdl_assoc_deleted)
+        {
+            continue;
+        }
+        if (!mdl_assoc_is_live(assoc))
+        {
+            table->slots[slot] = &mdl_assoc_deleted;
+            table->size--;
+            continue;
+        }
+        if (assoc->hash == hash && mdl_assoc_key_equals(*assoc->key, inkey))
+        {
+            return (int)slot;
+        }
+    }
+    return -1;
+}
+
+static mdl_assoc_t *mdl_find_assoc(mdl_assoc_table_t *table, const mdl_assoc_key_t &inkey)
+{
+    int slot = mdl_find_assoc_slot(table, inkey, mdl_hash_assoc_key(inkey));
+    return (slot >= 0) ? table->slots[slot] : nullptr;
 }
 
 mdl_value_t *mdl_assoc_find_value(mdl_assoc_table_t *table, const mdl_assoc_key_t &inkey)
 {
+    if (mdl_assoc_key_on_atom(inkey))
+    {
+        mdl_atom_prop_t *prop = mdl_find_atom_prop(inkey);
+        return prop ? prop->value : nullptr;
+    }
     mdl_assoc_t *assoc = mdl_find_assoc(table, inkey);
     return (assoc) ? assoc->value : nullptr;
 }
 
 mdl_value_t *mdl_delete_assoc(mdl_assoc_table_t *table, const mdl_assoc_key_t &inkey)
 {
-    if (table->last_clean != GC_get_gc_no())
+    if (mdl_assoc_key_on_atom(inkey))
     {
-        mdl_assoc_clean(table);
-    }
-    int bucketnum = mdl_hash_assoc_key(inkey) % table->nbuckets;
-    mdl_assoc_t *cursor = table->buckets[bucketnum];
-    if (!cursor)
-    {
-        return nullptr; // no bucket means there was no such association
+        mdl_atom_prop_t *prop = mdl_find_atom_prop(inkey);
+        if (!prop)
+        {
+            return nullptr;
+        }
+        mdl_value_t *value = prop->value;
+        mdl_atom_props_t *props = inkey.item->v.a->props;
+        mdl_delete_atom_prop(table, props, prop - props->props);
+        return value;
     }
-    // 1st item is special
-    if (mdl_assoc_key_equals(*cursor->key, inkey))
+    int slot = mdl_find_assoc_slot(table, inkey, mdl_hash_assoc_key(inkey));
+    if (slot < 0)
     {
-        table->buckets[bucketnum] = cursor->next;
-        table->size--;
-        return cursor->value;
+        return nullptr;
     }
-    mdl_assoc_t *lastcursor = cursor;
-    cursor = cursor->next;
+    mdl_value_t *value = table->slots[slot]->value;
+    table->slots[slot] = &mdl_assoc_deleted;
+    table->size--;
+    return value;
+}
 
-    while (cursor)
+// strong makes the association hold its item and indicator, so they
+// can't be collected while it exists; see mdl_assoc_value_is_permanent
+// for the ones held strongly anyway.  Properties kept on atoms are
+// always held strongly
+bool mdl_add_assoc(mdl_assoc_table_t *table, const mdl_assoc_key_t &inkey, mdl_value_t *value, bool strong)
+{
+    if (mdl_assoc_key_on_atom(inkey))
     {
-        if (mdl_assoc_key_equals(*cursor->key, inkey))
+        mdl_atom_prop_t *prop = mdl_find_atom_prop(inkey);
+        if (prop)
         {
-            lastcursor->next = cursor->next;
-            table->size--;
-            return cursor->value;
+            prop->value = value;
+            return false;
         }
-        lastcursor = cursor;
-        cursor = cursor->next;
+        mdl_add_atom_prop(table, inkey, value);
+        return true;
     }
-    return nullptr;
-}
-
-bool mdl_add_assoc(mdl_assoc_table_t *table, const mdl_assoc_key_t &inkey, mdl_value_t *value)
-{
     mdl_assoc_t *assoc = mdl_find_assoc(table, inkey);
     if (!assoc)
     {
+        if (table->used >= table->nslots / 2)
+        {
+            mdl_rehash_assoc_table(table);
+        }
         mdl_assoc_key_t *key = GC_NEW_ATOMIC(mdl_assoc_key_t);
         *key = inkey;
         assoc = GC_NEW(mdl_assoc_t);
+        assoc->hash = mdl_hash_assoc_key(*key);
         assoc->key = key;
         assoc->value = value;
-        assoc->item_exists = (void *)1;//&key->item;
-        assoc->indicator_exists = (void *)1;//&key->indicator;
-        GC_GENERAL_REGISTER_DISAPPEARING_LINK(&assoc->item_exists, key->item);
-        GC_GENERAL_REGISTER_DISAPPEARING_LINK(&assoc->indicator_exists, key->indicator);
-        int bucketnum = mdl_hash_assoc_key(*key) % table->nbuckets;
-        assoc->next = table->buckets[bucketnum];
-        table->buckets[bucketnum] = assoc;
+        assoc->held = strong;
+        mdl_assoc_hold(&assoc->item_exists, key->item,
+            strong || mdl_assoc_value_is_permanent(key->item));
+        mdl_assoc_hold(&assoc->indicator_exists, key->indicator,
+            strong || mdl_assoc_value_is_permanent(key->indicator));
+        // the first deleted slot on the way is as good as an empty one
+        size_t mask = table->nslots - 1;
+        size_t slot = assoc->hash & mask;
+        while (table->slots[slot] && table->slots[slot] != &mdl_assoc_deleted)
+        {
+            slot = (slot + 1) & mask;
+        }
+        if (!table->slots[slot])
+        {
+            table->used++;
+        }
+        table->slots[slot] = assoc;
         table->size++;
         return true;
     }
     else
     {
         assoc->value = value;
+        if (strong)
+        {
+            assoc->held = true;
+            mdl_assoc_hold(&assoc->item_exists, assoc->key->item, true);
+            mdl_assoc_hold(&assoc->indicator_exists, assoc->key->indicator, true);
+        }
         return false;
     }
 }
 
+// An ATOM taken off its oblist may be collected after all, so the
+// associations holding it only because it was on one (not because of
+// PUTPROP-STRONG) go back to watching it with a link.  REMOVE is rare
+// enough to walk the table for
+void mdl_assoc_atom_removed(mdl_assoc_table_t *table, const atom_t *atom)
+{
+    for (int i = 0; i < table->nslots; i++)
+    {
+        mdl_assoc_t *assoc = table->slots[i];
+        if (!assoc || assoc == &mdl_assoc_deleted || assoc->held || !mdl_assoc_is_live(assoc))
+        {
+            continue;
+        }
+        mdl_value_t *item = assoc->key->item;
+        mdl_value_t *indicator = assoc->key->indicator;
+        if (assoc->item_exists != (void *)1 && item->type == MDL_TYPE_ATOM && item->v.a == atom)
+        {
+            mdl_assoc_hold(&assoc->item_exists, item, false);
+        }
+        if (assoc->indicator_exists != (void *)1 && indicator->type == MDL_TYPE_ATOM && indicator->v.a == atom)
+        {
+            mdl_assoc_hold(&assoc->indicator_exists, indicator, false);
+        }
+    }
+}
+
 bool mdl_assoc_clean(mdl_assoc_table_t *table)
 {
-    mdl_assoc_iterator_t *iter = mdl_assoc_iterator_first(table);
     bool result = false;
 
 //    std::fprintf(stderr, "ASSOC cleaning %d %p %lu %lu\n", table->size, table, table->last_clean, GC_gc_no);
-    while (!mdl_assoc_iterator_at_end(iter))
+    for (int slot = 0; slot < table->nslots; slot++)
     {
-        if (!iter->assoc->item_exists || !iter->assoc->indicator_exists)
+        mdl_assoc_t *assoc = table->slots[slot];
+        if (assoc && assoc != &mdl_assoc_deleted && !mdl_assoc_is_live(assoc))
         {
 //            std::fprintf(stderr, "Nuking an association\n");
-            mdl_assoc_iterator_delete(iter);
+            table->slots[slot] = &mdl_assoc_deleted;
+            table->size--;
             result = true;
         }
-        else
+    }
+    // the properties of collected atoms went with them; their records,
+    // and those of atoms with no properties left, are squeezed out
+    int natom_props = 0;
+    int natoms = 0;
+    for (int i = 0; i < table->natoms; i++)
+    {
+        mdl_atom_props_t *props = mdl_assoc_atom_props(table, i);
+        mdl_assoc_atom_t *record = mdl_assoc_atom_record(table, i);
+        if (!props || !props->nprops)
+        {
+            if (props)
+            {
+                record->atom->props = nullptr;
+                GC_unregister_disappearing_link(&record->exists);
+            }
+            continue;
+        }
+        natom_props += props->nprops;
+        if (natoms != i)
         {
-            mdl_assoc_iterator_increment(iter);
+            mdl_assoc_atom_t *to = mdl_assoc_atom_record(table, natoms);
+            to->atom = record->atom;
+            to->exists = (void *)1;
+            GC_unregister_disappearing_link(&record->exists);
+            GC_GENERAL_REGISTER_DISAPPEARING_LINK(&to->exists, to->atom);
         }
+        natoms++;
     }
+    result = result || natom_props != table->natom_props;
+    table->natom_props = natom_props;
+    table->natoms = natoms;
+    table->natom_chunks = (natoms + MDL_ASSOC_ATOM_CHUNK - 1) / MDL_ASSOC_ATOM_CHUNK;
     table->last_clean = GC_get_gc_no();
+    table->clean_slot = table->nslots;
 //    std::fprintf(stderr, "ASSOC cleaning done %d\n", table->size);
     return result;
 }
 
-mdl_assoc_iterator_t *mdl_assoc_iterator_first(mdl_assoc_table_t *table)
+// move iter to the first association at or after where it is
+static void mdl_assoc_iterator_seek(mdl_assoc_iterator_t *iter)
 {
-    mdl_assoc_iterator_t *iter = GC_NEW(mdl_assoc_iterator_t);
-
-    for (int i = 0; i < table->nbuckets; i++)
+    mdl_assoc_table_t *table = iter->table;
+    for (; iter->slot < table->nslots; iter->slot++)
     {
-        if ((iter->assoc = table->buckets[i]) != nullptr)
+        mdl_assoc_t *assoc = table->slots[iter->slot];
+        if (assoc && assoc != &mdl_assoc_deleted)
         {
-            iter->bucket = i;
-            break;
+            iter->key = assoc->key;
+            iter->value = assoc->value;
+            return;
         }
     }
+    for (; iter->atom < table->natoms; iter->atom++, iter->prop = 0)
+    {
+        mdl_atom_props_t *props = mdl_assoc_atom_props(table, iter->atom);
+        if (props && iter->prop < props->nprops)
+        {
+            iter->key = &props->props[iter->prop].key;
+            iter->value = props->props[iter->prop].value;
+            return;
+        }
+    }
+    iter->key = nullptr;
+    iter->value = nullptr;
+}
+
+mdl_assoc_iterator_t *mdl_assoc_iterator_first(mdl_assoc_table_t *table)
+{
+    mdl_assoc_iterator_t *iter = GC_NEW(mdl_assoc_iterator_t);
     iter->table = table;
+    mdl_assoc_iterator_seek(iter);
     return iter;
 }
 
 bool mdl_assoc_iterator_increment(mdl_assoc_iterator_t *iter)
 {
-    if (iter->assoc == nullptr)
+    if (iter->key == nullptr)
     {
         return false; // iter's already dead, dude
     }
-    iter->assoc = iter->assoc->next;
-    while (iter->assoc == nullptr && (++iter->bucket < iter->table->nbuckets))
+    if (iter->slot < iter->table->nslots)
     {
-        iter->assoc = iter->table->buckets[iter->bucket];
+        iter->slot++;
     }
+    else
+    {
+        iter->prop++;
+    }
+    mdl_assoc_iterator_seek(iter);
     return true;
 }
 
@@ -237,40 +586,23 @@ bool mdl_assoc_iterator_increment(mdl_assoc_iterator_t *iter)
 // have been GCed.
 bool mdl_assoc_iterator_delete(mdl_assoc_iterator_t *iter)
 {
-    if (iter->assoc == nullptr)
+    if (iter->key == nullptr)
     {
         return false; // iter's already dead, dude
     }
 
-    bool result = false;
-    mdl_assoc_t *cursor = iter->table->buckets[iter->bucket];
-    // 1st item is special
-    if (cursor == iter->assoc)
+    mdl_assoc_table_t *table = iter->table;
+    if (iter->slot < table->nslots)
     {
-        iter->table->buckets[iter->bucket] = cursor->next;
-        iter->table->size--;
-        result = true;
+        table->slots[iter->slot] = &mdl_assoc_deleted;
+        table->size--;
+        iter->slot++;
     }
     else
     {
-        mdl_assoc_t *lastcursor = cursor;
-        cursor = cursor->next;
-
-        while (cursor)
-        {
-            if (cursor == iter->assoc)
-            {
-                lastcursor->next = cursor->next;
-                iter->table->size--;
-                result = true;
-                break;
-            }
-            lastcursor = cursor;
-            cursor = cursor->next;
-        }
+        // the next property moves down into this one's place
+        mdl_delete_atom_prop(table, mdl_assoc_atom_props(table, iter->atom), iter->prop);
     }
-    // increment still works because it doesn't require iter to actually
-    // exist in the table
-    mdl_assoc_iterator_increment(iter);
-    return result;
+    mdl_assoc_iterator_seek(iter);
+    return true;
 }
@@ -20,56 +20,67 @@
 
 struct mdl_assoc_t
 {
-    struct mdl_assoc_t *next;
+    size_t hash;
     struct mdl_assoc_key_t *key;
     mdl_value_t *value;
+    // (void *)1 while the item or indicator exists, cleared by a
+    // disappearing link when it is collected -- or, if the association
+    // holds it strongly, the item or indicator itself, with no link
     void *item_exists;
     void *indicator_exists;
+    bool held; // held strongly because PUTPROP-STRONG asked
 };
 
+// open addressing, with linear probing.  A slot is empty, deleted
+// (mdl_assoc_deleted), or holds an association
 struct mdl_assoc_table_t
 {
-    int nbuckets;
-    int size;
-    GC_word last_clean;
-    mdl_assoc_t *buckets[1];
+    int nslots; // a power of 2
+    int size;   // associations in the table
+    int used;   // slots that aren't empty, deleted ones included
+    GC_word last_clean; // collection the current sweep started after
+    int clean_slot;     // where that sweep has got to
+    mdl_assoc_t **slots;
+    // atoms given properties through this table, in chunks of
+    // MDL_ASSOC_ATOM_CHUNK that are never moved
+    int natoms;
+    int natom_chunks;
+    struct mdl_assoc_atom_t **atom_chunks;
+    int natom_props; // properties those atoms hold
 };
 
+// Walks the table's slots, then the properties of its atoms.  key and
+// value are null at the end
 struct mdl_assoc_iterator_t
 {
     mdl_assoc_table_t *table;
-    int bucket;
-    mdl_assoc_t *assoc;
+    int slot;
+    int atom;
+    int prop;
+    const mdl_assoc_key_t *key;
+    mdl_value_t *value;
 };
 
 inline int
 mdl_assoc_table_size(mdl_assoc_table_t *table)
 {
-    return table->size;
+    return table->size + table->natom_props;
 }
 
 inline bool
 mdl_assoc_iterator_at_end(const mdl_assoc_iterator_t *iter)
 {
-    return iter->assoc == nullptr;
+    return iter->key == nullptr;
 }
 
 inline const mdl_assoc_key_t *mdl_assoc_iterator_get_key(mdl_assoc_iterator_t *iter)
 {
-    if (!iter->assoc)
-    {
-        return nullptr;
-    }
-    return (const mdl_assoc_key_t *)iter->assoc->key;
+    return iter->key;
 }
 
 inline mdl_value_t *mdl_assoc_iterator_get_value(mdl_assoc_iterator_t *iter)
 {
-    if (!iter->assoc)
-    {
-        return nullptr;
-    }
-    return iter->assoc->value;
+    return iter->value;
 }
 
 mdl_assoc_table_t *mdl_create_assoc_table();
@@ -77,7 +88,8 @@ bool mdl_assoc_clean(mdl_assoc_table_t *table);
 void mdl_clear_assoc_table(mdl_assoc_table_t *table);
 int mdl_swap_assoc_table(mdl_assoc_table_t *t1, mdl_assoc_table_t *t2);
 
-bool mdl_add_assoc(mdl_assoc_table_t *table, const mdl_assoc_key_t &inkey, mdl_value_t *value);
+bool mdl_add_assoc(mdl_assoc_table_t *table, const mdl_assoc_key_t &inkey, mdl_value_t *value, bool strong = false);
+void mdl_assoc_atom_removed(mdl_assoc_table_t *table, const atom_t *atom);
 mdl_value_t *mdl_assoc_find_value(mdl_assoc_table_t *table, const mdl_assoc_key_t &inkey);
 
 mdl_value_t *mdl_delete_assoc(mdl_assoc_table_t *table, const mdl_assoc_key_t &inkey);
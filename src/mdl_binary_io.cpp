@@ -24,6 +24,7 @@
 #include "mdl_builtins.h"
 #include "mdl_builtin_types.h"
 #include "mdl_assoc.hpp"
+#include "mdl_compile.hpp"
 
 //#define MDL_DEBUG_BINARY_IO
 
@@ -736,7 +737,7 @@ void mdl_write_atom(std::FILE *f, atom_t *a)
     mdl_write_intptr(f, objnum);
 }
 
-int mdl_read_atom(std::FILE *f, atom_t **ap, mdl_symbol_table_t *global, mdl_local_symbol_table_t *local)
+int mdl_read_atom(std::FILE *f, atom_t **ap, mdl_global_atoms_t *global, mdl_local_symbol_table_t *local)
 {
     // atom is pname(obj), type, oblist(obj), globalsym(obj), localsym(obj)
     //OBJTYPE will have been read already
@@ -766,12 +767,12 @@ int mdl_read_atom(std::FILE *f, atom_t **ap, mdl_symbol_table_t *global, mdl_loc
         return -1;
     }
 
-    mdl_symbol_t sym;
-    sym.atom = a;
-    sym.binding = (mdl_value_t *)objnum;
     if (objnum != 0)
     {
-        global->emplace(a, sym);
+        a->global = GC_NEW(mdl_symbol_t);
+        a->global->atom = a;
+        a->global->binding = (mdl_value_t *)objnum;
+        global->push_back(a);
     }
 
     if (mdl_read_intptr(f, &objnum) != 0)
@@ -789,7 +790,7 @@ int mdl_read_atom(std::FILE *f, atom_t **ap, mdl_symbol_table_t *global, mdl_loc
     return 0;
 }
 
-int mdl_fixup_atom(atom_t *a, mdl_symbol_table_t *global, mdl_local_symbol_table_t *local)
+int mdl_fixup_atom(atom_t *a, mdl_local_symbol_table_t *local)
 {
     // atom is pname(obj), type, oblist(obj), globalsym(obj), localsym(obj)
     intptr_t objnum = (intptr_t)a->pname;
@@ -799,6 +800,7 @@ int mdl_fixup_atom(atom_t *a, mdl_symbol_table_t *global, mdl_local_symbol_table
         return -1;
     }
     a->pname = (char *)obj->ptr; // pnames don't need length adjustment
+    a->hash = mdl_hash_pname(a->pname);
 
     objnum = (intptr_t)a->oblist;
     obj = find_obj_by_num(objnum, OBJTYPE_MDL_VALUE);
@@ -808,16 +810,15 @@ int mdl_fixup_atom(atom_t *a, mdl_symbol_table_t *global, mdl_local_symbol_table
     }
     a->oblist = (mdl_value_t *)obj->ptr; // pnames don't need length adjustment
 
-    auto iter = global->find(a);
-    if (iter != global->end())
+    if (a->global)
     {
-        objnum = (intptr_t)iter->second.binding;
+        objnum = (intptr_t)a->global->binding;
         obj = find_obj_by_num(objnum, OBJTYPE_MDL_VALUE);
         if (!obj)
         {
             return -1;
         }
-        iter->second.binding = (mdl_value_t *)obj->ptr;
+        a->global->binding = (mdl_value_t *)obj->ptr;
     }
 
     auto liter = local->find(a);
@@ -1499,7 +1500,7 @@ void mdl_write_image(std::FILE *f, mdl_value_t *save_arg)
 bool mdl_read_image(std::FILE *f)
 {
     obj_in_image_t obj;
-    mdl_symbol_table_t newglobal;
+    mdl_global_atoms_t newglobal;
     mdl_local_symbol_table_t newlocal;
     mdl_value_t *new_root_oblist = nullptr;
     mdl_value_t *new_initial_oblist = nullptr;
@@ -1674,7 +1675,7 @@ bool mdl_read_image(std::FILE *f)
         }
         case OBJTYPE_ATOM:
         {
-            err = mdl_fixup_atom((atom_t *)obj.ptr, &newglobal, &newlocal);
+            err = mdl_fixup_atom((atom_t *)obj.ptr, &newlocal);
             break;
         }
         case OBJTYPE_RAWSTRING:
@@ -1738,12 +1739,7 @@ bool mdl_read_image(std::FILE *f)
     mdl_value_initial_oblist = new_initial_oblist;
     mdl_value_oblist = new_mdl_value_atom_oblist;
     atom_oblist = mdl_value_oblist->v.a;
-    mdl_value_atom_redefine = mdl_get_or_create_atom_on_oblist("REDEFINE", mdl_value_root_oblist);
-    mdl_value_atom_default = mdl_get_or_create_atom_on_oblist("DEFAULT", mdl_value_root_oblist);
-    mdl_value_T = mdl_get_or_create_atom_on_oblist("T", mdl_value_root_oblist);
-
-    mdl_value_atom_lastprog = mdl_get_or_create_atom_on_oblist("LPROG ", mdl_value_interrupts_oblist);
-    mdl_value_atom_lastmap = mdl_get_or_create_atom_on_oblist("LPROG ", mdl_value_interrupts_oblist);
+    mdl_find_known_atoms(mdl_value_root_oblist, mdl_value_interrupts_oblist);
 
     // swap in the new structures
     built_in_table.clear();
@@ -1751,12 +1747,23 @@ bool mdl_read_image(std::FILE *f)
 
     mdl_type_table.clear();
     mdl_type_table.swap(new_types);
+    mdl_rebuild_type_flags();
 
-    global_syms.clear();
+    // the old atoms lose their GVALs, as if the old table were gone
+    for (atom_t *a : global_syms)
+    {
+        a->global = nullptr;
+    }
     global_syms.swap(newglobal);
+    MDL_BUMP_GLOBAL_EPOCH();
+    mdl_invalidate_code();
 
-    initial_frame->syms->clear();
-    initial_frame->syms->swap(newlocal);
+    mdl_unbind_all_frames();
+    mdl_clear_frame_bindings(initial_frame);
+    for (auto const &elem : newlocal)
+    {
+        mdl_bind_local_symbol(elem.second.atom, elem.second.binding, initial_frame, false);
+    }
 
     mdl_clear_assoc_table(mdl_assoc_table);
     mdl_swap_assoc_table(mdl_assoc_table, new_assoc_hash);
@@ -1780,6 +1787,6 @@ bool mdl_read_image(std::FILE *f)
 #ifdef GC_DEBUG
     GC_gcollect();
 #endif
-    std::longjmp(initial_frame->interp_frame, LONGJMP_RESTORE);
+    std::longjmp(*initial_frame->interp_frame, LONGJMP_RESTORE);
     return true;
 }
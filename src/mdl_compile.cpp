@@ -0,0 +1,1230 @@
+/*****************************************************************************/
+/*    'Confusion', a MDL intepreter                                         */
+/*    Copyright 2009 Matthew T. Russotto                                    */
+/*                                                                          */
+/*    This program is free software: you can redistribute it and/or modify  */
+/*    it under the terms of the GNU General Public License as published by  */
+/*    the Free Software Foundation, version 3 of 29 June 2007.              */
+/*                                                                          */
+/*    This program is distributed in the hope that it will be useful,       */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/*    GNU General Public License for more details.                          */
+/*                                                                          */
+/*    You should have received a copy of the GNU General Public License     */
+/*    along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*****************************************************************************/
+#include <gc/gc.h>
+
+#include <algorithm>
+#include <cstring>
+#include <alloca.h>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "macros.hpp"
+#include "mdl_internal_defs.h"
+#include "mdl_builtins.h"
+#include "mdl_compile.hpp"
+
+// Bodies are compiled the first time they are run.  Every decision the
+// compiler makes from the current global value of an atom is checked
+// again when the code runs (the GUARD and CALLHEAD instructions), and
+// falls back to applying the original form, so redefining COND or SET
+// is still honored.  What the compiler can't check at run time --
+// EVALTYPE/APPLYTYPE, which invalidates all compiled code through
+// mdl_code_epoch, and the list structure of the body itself, which
+// drops whatever was built from the cell changed.
+
+#define MDL_CODE_CACHE_SIZE 512
+
+unsigned mdl_code_epoch = 1;
+
+mdl_value_t mdl_value_tail_call;
+mdl_value_t *mdl_tail_applier;
+mdl_value_t *mdl_tail_apply_to;
+
+// a cache slot, and the list cells what it holds was made from
+struct mdl_cache_entry_t
+{
+    const mdl_value_t *key;
+    std::vector<const mdl_value_t *> cells;
+};
+
+struct mdl_code_slot_t : mdl_cache_entry_t
+{
+    mdl_code_t *code;
+};
+
+static mdl_code_slot_t mdl_function_code_cache[MDL_CODE_CACHE_SIZE];
+static mdl_code_slot_t mdl_body_code_cache[MDL_CODE_CACHE_SIZE];
+
+// MACRO expansions, by the first cell of the FORM expanded.  One is good
+// while the same MACRO object is applied (DEFMAC and SETG make a new
+// one) and nothing drops it (PUT or PUTREST anywhere in the form or in
+// the MACRO's body, or a new epoch).  An expansion that looked up any
+// GVAL, like <DEFMAC N () ,FLAG>'s, isn't kept at all.  The appliers
+// it called through the call-site cache are covered by
+// mdl_global_epoch.  EXPAND always expands afresh
+struct mdl_expansion_slot_t : mdl_cache_entry_t
+{
+    const mdl_value_t *macro;
+    mdl_value_t *expansion;
+    unsigned epoch;
+    unsigned global_epoch;
+};
+
+static mdl_expansion_slot_t mdl_expansion_cache[MDL_CODE_CACHE_SIZE];
+
+// parsed argument lists, by the first cell of the list
+struct mdl_argspec_cache_slot_t : mdl_cache_entry_t
+{
+    mdl_argspec_t *spec;
+    bool auxonly;
+    unsigned epoch;
+};
+
+static mdl_argspec_cache_slot_t mdl_argspec_cache[MDL_CODE_CACHE_SIZE];
+static mdl_argspec_t mdl_argspec_empty;
+
+// the cache slots depending on each list cell.  A slot's cells are
+// dropped when it is refilled, so this holds no more than the caches
+// do.  Not traced by the GC; a stale cell can only cause a needless
+// recompile
+static std::unordered_multimap<const mdl_value_t *, mdl_cache_entry_t *> mdl_watched_cells;
+
+// cells watched since the outermost fill began.  A nested fill (the
+// argument list of a PROG compiled in line) takes the cells from its
+// mark, and leaves them for the outer one too
+static std::vector<const mdl_value_t *> mdl_watch_log;
+
+// The frames code will run under, innermost first, as far as the
+// compiler can tell: a FUNCTION's, and the ones COND, AND, OR, PROG and
+// REPEAT compiled in line push above it.  atoms are in the order they
+// are bound, so the position of one is the slot it gets.  A frame
+// whose bindings aren't known ends the chain
+struct mdl_lexical_frame_t
+{
+    const mdl_lexical_frame_t *outer;
+    std::vector<atom_t *> atoms;
+};
+
+struct mdl_compiler_t
+{
+    std::vector<mdl_insn_t> insns;
+    int depth;
+    int maxdepth;
+    const mdl_lexical_frame_t *frames;
+};
+
+static inline size_t mdl_code_hash(const mdl_value_t *key)
+{
+    uintptr_t h = (uintptr_t)key;
+    h ^= h >> 12;
+    return (h >> 4) & (MDL_CODE_CACHE_SIZE - 1);
+}
+
+static inline mdl_code_slot_t *mdl_code_slot(mdl_code_slot_t *cache, const mdl_value_t *key)
+{
+    return &cache[mdl_code_hash(key)];
+}
+
+void mdl_invalidate_code()
+{
+    if (!++mdl_code_epoch)
+    {
+        ++mdl_code_epoch;
+    }
+}
+
+static void mdl_drop_entry(mdl_cache_entry_t *entry)
+{
+    for (const mdl_value_t *cell : entry->cells)
+    {
+        auto range = mdl_watched_cells.equal_range(cell);
+        for (auto iter = range.first; iter != range.second; ++iter)
+        {
+            if (iter->second == entry)
+            {
+                mdl_watched_cells.erase(iter);
+                break;
+            }
+        }
+    }
+    entry->cells.clear();
+    entry->key = nullptr;
+}
+
+// fills entry with key, depending on the cells watched since mark
+static void mdl_fill_entry(mdl_cache_entry_t *entry, const mdl_value_t *key, size_t mark)
+{
+    mdl_drop_entry(entry);
+    entry->key = key;
+    entry->cells.assign(mdl_watch_log.begin() + mark, mdl_watch_log.end());
+    std::sort(entry->cells.begin(), entry->cells.end());
+    entry->cells.erase(std::unique(entry->cells.begin(), entry->cells.end()), entry->cells.end());
+    for (const mdl_value_t *cell : entry->cells)
+    {
+        mdl_watched_cells.emplace(cell, entry);
+    }
+    if (!mark)
+    {
+        mdl_watch_log.clear();
+    }
+}
+
+void mdl_code_cell_changed(const mdl_value_t *cell)
+{
+    if (mdl_watched_cells.empty())
+    {
+        return;
+    }
+    auto range = mdl_watched_cells.equal_range(cell);
+    if (range.first == range.second)
+    {
+        return;
+    }
+    std::vector<mdl_cache_entry_t *> entries;
+    for (auto iter = range.first; iter != range.second; ++iter)
+    {
+        entries.push_back(iter->second);
+    }
+    for (mdl_cache_entry_t *entry : entries)
+    {
+        mdl_drop_entry(entry);
+    }
+}
+
+static void mdl_watch_cells(const mdl_value_t *cell)
+{
+    while (cell)
+    {
+        mdl_watch_log.push_back(cell);
+        cell = cell->v.p.cdr;
+    }
+}
+
+// watches every list cell reachable from v, for what may depend on
+// any of them (a MACRO expansion)
+static void mdl_watch_structure(const mdl_value_t *v)
+{
+    if (!v || v->pt != PRIMTYPE_LIST)
+    {
+        return;
+    }
+    std::vector<const mdl_value_t *> todo;
+    std::unordered_set<const mdl_value_t *> seen;
+    todo.push_back(v->v.p.cdr);
+    while (!todo.empty())
+    {
+        const mdl_value_t *cell = todo.back();
+        todo.pop_back();
+        for (; cell && seen.insert(cell).second; cell = cell->v.p.cdr)
+        {
+            mdl_watch_log.push_back(cell);
+            const mdl_value_t *item = cell->v.p.car;
+            if (item && item->pt == PRIMTYPE_LIST && item->v.p.cdr)
+            {
+                todo.push_back(item->v.p.cdr);
+            }
+        }
+    }
+}
+
+static inline bool mdl_is_builtin(const mdl_value_t *v, const mdl_value_t *builtin)
+{
+    return v && v->type == builtin->type && v->v.w == builtin->v.w;
+}
+
+static inline mdl_value_t *mdl_form_applier(mdl_value_t *form)
+{
+    return mdl_eval_apply_expr(form->v.p.cdr->v.p.car, form->v.p.cdr);
+}
+
+// true if EVAL returns the object itself
+static bool mdl_self_evaluating(const mdl_value_t *v)
+{
+    return (MDL_TYPE_FLAGS(v->type) & MDL_TYPE_FLAG_SELF_EVAL) != 0;
+}
+
+static int mdl_emit(mdl_compiler_t *c, int op, int stack_effect,
+                    mdl_value_t *form = nullptr,
+                    mdl_value_t *val = nullptr,
+                    mdl_value_t *aux = nullptr,
+                    int n = 0)
+{
+    mdl_insn_t insn;
+    std::memset(&insn, 0, sizeof(insn));
+    insn.op = op;
+    insn.n = n;
+    insn.form = form;
+    insn.val = val;
+    insn.aux = aux;
+    c->insns.push_back(insn);
+    c->depth += stack_effect;
+    if (c->depth > c->maxdepth)
+    {
+        c->maxdepth = c->depth;
+    }
+    return c->insns.size() - 1;
+}
+
+static inline int mdl_here(mdl_compiler_t *c)
+{
+    return c->insns.size();
+}
+
+static inline void mdl_patch(mdl_compiler_t *c, int insn, int target)
+{
+    c->insns[insn].target = target;
+}
+
+// find the frame and slot of the innermost binding of atom the compiler
+// knows about.  Only the inline slots have an address
+static bool mdl_lexical_address(const mdl_compiler_t *c, const atom_t *atom, int *hops, int *slot)
+{
+    int up = 0;
+    for (const mdl_lexical_frame_t *frame = c->frames; frame; frame = frame->outer, up++)
+    {
+        auto iter = std::find(frame->atoms.begin(), frame->atoms.end(), atom);
+        if (iter != frame->atoms.end())
+        {
+            *hops = up;
+            *slot = iter - frame->atoms.begin();
+            return *slot < MDL_FRAME_INLINE_SYMS;
+        }
+    }
+    return false;
+}
+
+static void mdl_compile_expr(mdl_compiler_t *c, mdl_value_t *expr, bool tail = false);
+static mdl_code_t *mdl_compile_sequence(mdl_value_t *body, bool tail, const mdl_lexical_frame_t *frames = nullptr);
+static mdl_code_t *mdl_finish_code(mdl_compiler_t *c);
+
+// compile a non-empty sequence of expressions, leaving the value of the
+// last on the stack.  With tail, that value is what the code returns,
+// so a FUNCTION call there may be a tail call
+static void mdl_compile_exprs(mdl_compiler_t *c, mdl_value_t *cell, bool tail)
+{
+    mdl_watch_cells(cell);
+    while (cell)
+    {
+        mdl_compile_expr(c, cell->v.p.car, tail && !cell->v.p.cdr);
+        cell = cell->v.p.cdr;
+        if (cell)
+        {
+            mdl_emit(c, MDL_OP_POP, -1);
+        }
+    }
+}
+
+static bool mdl_compile_cond(mdl_compiler_t *c, mdl_value_t *form, mdl_value_t *clauses, bool tail)
+{
+    if (!clauses)
+    {
+        return false;
+    }
+    // clauses are checked as COND reaches them; only compile if none
+    // of them can fail
+    for (mdl_value_t *cell = clauses; cell; cell = cell->v.p.cdr)
+    {
+        mdl_value_t *clause = cell->v.p.car;
+        if (clause->type != MDL_TYPE_LIST || !clause->v.p.cdr)
+        {
+            return false;
+        }
+    }
+
+    std::vector<int> to_end;
+    for (mdl_value_t *cell = clauses; cell; cell = cell->v.p.cdr)
+    {
+        mdl_value_t *clause = cell->v.p.car->v.p.cdr;
+        int base = c->depth;
+        mdl_watch_cells(clause);
+
+        mdl_compile_expr(c, clause->v.p.car);
+        int test = mdl_emit(c, MDL_OP_JUMP_FALSE, 0);
+        if (clause->v.p.cdr)
+        {
+            mdl_emit(c, MDL_OP_POP, -1);
+            mdl_compile_exprs(c, clause->v.p.cdr, tail);
+        }
+        to_end.push_back(mdl_emit(c, MDL_OP_JUMP, 0));
+        // a failed test arrives with its value still pushed
+        c->depth = base + 1;
+        if (cell->v.p.cdr)
+        {
+            mdl_patch(c, test, mdl_here(c));
+            mdl_emit(c, MDL_OP_POP, -1);
+        }
+        else
+        {
+            to_end.push_back(test);
+        }
+    }
+    for (int insn : to_end)
+    {
+        mdl_patch(c, insn, mdl_here(c));
+    }
+    return true;
+}
+
+static bool mdl_compile_and_or(mdl_compiler_t *c, mdl_value_t *form, mdl_value_t *args, bool is_and, bool tail)
+{
+    if (!args)
+    {
+        return false;
+    }
+    std::vector<int> to_end;
+    for (mdl_value_t *cell = args; cell; cell = cell->v.p.cdr)
+    {
+        mdl_compile_expr(c, cell->v.p.car, tail && !cell->v.p.cdr);
+        if (cell->v.p.cdr)
+        {
+            to_end.push_back(mdl_emit(c, is_and ? MDL_OP_JUMP_FALSE : MDL_OP_JUMP_TRUE, 0));
+            mdl_emit(c, MDL_OP_POP, -1);
+        }
+    }
+    for (int insn : to_end)
+    {
+        mdl_patch(c, insn, mdl_here(c));
+    }
+    return true;
+}
+
+static bool mdl_compile_prog(mdl_compiler_t *c, mdl_value_t *form, mdl_value_t *args, bool repeat, bool tail)
+{
+    // <PROG [act] (aux...) body...>
+    mdl_value_t *rest = args;
+    if (rest && rest->v.p.car->type == MDL_TYPE_ATOM)
+    {
+        rest = rest->v.p.cdr;
+    }
+    if (!rest || rest->v.p.car->type != MDL_TYPE_LIST || !rest->v.p.cdr)
+    {
+        return false;
+    }
+    mdl_watch_cells(args);
+
+    // as bound by mdl_internal_prog_repeat_bind for MDL_OP_PROG
+    mdl_lexical_frame_t frame;
+    frame.outer = nullptr;
+    mdl_argspec_t *spec = c->frames ? mdl_fargs_spec(rest->v.p.car, true) : nullptr;
+    if (spec && !spec->bad)
+    {
+        frame.outer = c->frames;
+        if (rest != args)
+        {
+            frame.atoms.push_back(args->v.p.car->v.a);
+        }
+        for (int i = 0; i < spec->nslots; i++)
+        {
+            frame.atoms.push_back(spec->slots[i].atom);
+        }
+    }
+
+    int prog = mdl_emit(c, MDL_OP_PROG, 1, form, nullptr, nullptr, repeat);
+    // a REPEAT body is run again, so it has no tail
+    c->insns[prog].code = mdl_compile_sequence(rest->v.p.cdr, tail && !repeat,
+                                               frame.outer ? &frame : nullptr);
+    return true;
+}
+
+// FSUBRs compiled in line still run in their own frame, so FRAME, ERRET
+// and RETRY see the same stack the evaluator would build
+static bool mdl_compile_fsubr(mdl_compiler_t *c, mdl_value_t *form, mdl_value_t *args, mdl_value_t *builtin, bool tail)
+{
+    // the FSUBR's own frame binds nothing
+    mdl_lexical_frame_t frame;
+    frame.outer = c->frames;
+    mdl_compiler_t sub;
+    sub.depth = sub.maxdepth = 0;
+    sub.frames = c->frames ? &frame : nullptr;
+
+    bool ok;
+    if (builtin == mdl_value_builtin_cond)
+    {
+        ok = mdl_compile_cond(&sub, form, args, tail);
+    }
+    else if (builtin == mdl_value_builtin_and || builtin == mdl_value_builtin_or)
+    {
+        ok = mdl_compile_and_or(&sub, form, args, builtin == mdl_value_builtin_and, tail);
+    }
+    else
+    {
+        ok = mdl_compile_prog(&sub, form, args, builtin == mdl_value_builtin_repeat, tail);
+    }
+    if (!ok)
+    {
+        return false;
+    }
+    int insn = mdl_emit(c, MDL_OP_FSUBR, 1, form, nullptr, builtin);
+    c->insns[insn].code = mdl_finish_code(&sub);
+    return true;
+}
+
+static bool mdl_compile_form(mdl_compiler_t *c, mdl_value_t *form, bool tail)
+{
+    mdl_value_t *first = form->v.p.cdr;
+    if (!first || first->v.p.car->type != MDL_TYPE_ATOM)
+    {
+        return false;
+    }
+    mdl_value_t *head = first->v.p.car;
+    mdl_value_t *args = first->v.p.cdr;
+    int nargs = 0;
+    bool segments = false;
+    for (mdl_value_t *cell = args; cell; cell = cell->v.p.cdr)
+    {
+        nargs++;
+        if (mdl_eval_type(cell->v.p.car->type) == MDL_TYPE_SEGMENT)
+        {
+            segments = true;
+        }
+    }
+
+    // the current global value is only a hint; every specialization is
+    // guarded at run time
+    mdl_value_t *hint = mdl_global_symbol_lookup(head->v.a);
+    if (hint && (hint->type == MDL_TYPE_SUBR || hint->type == MDL_TYPE_FSUBR))
+    {
+        mdl_value_t *arg1 = args ? args->v.p.car : nullptr;
+        bool atom_arg = arg1 && arg1->type == MDL_TYPE_ATOM && mdl_self_evaluating(arg1);
+
+        if (mdl_is_builtin(hint, mdl_value_builtin_lval) && nargs == 1 && atom_arg)
+        {
+            mdl_watch_cells(first);
+            int hops, slot;
+            if (mdl_lexical_address(c, arg1->v.a, &hops, &slot))
+            {
+                int insn = mdl_emit(c, MDL_OP_LOCAL, 1, form, arg1, mdl_value_builtin_lval, slot);
+                mdl_patch(c, insn, hops);
+            }
+            else
+            {
+                mdl_emit(c, MDL_OP_LVAL, 1, form, arg1, mdl_value_builtin_lval);
+            }
+            return true;
+        }
+        if (mdl_is_builtin(hint, mdl_value_builtin_gval) && nargs == 1 && atom_arg)
+        {
+            mdl_watch_cells(first);
+            mdl_emit(c, MDL_OP_GVAL, 1, form, arg1, mdl_value_builtin_gval);
+            return true;
+        }
+        if (mdl_is_builtin(hint, mdl_value_builtin_quote) && nargs == 1)
+        {
+            mdl_watch_cells(first);
+            int guard = mdl_emit(c, MDL_OP_GUARD, 0, form, nullptr, mdl_value_builtin_quote);
+            mdl_emit(c, MDL_OP_CONST, 1, nullptr, arg1);
+            mdl_patch(c, guard, mdl_here(c));
+            return true;
+        }
+        if (mdl_is_builtin(hint, mdl_value_builtin_set) && nargs == 2 && atom_arg && !segments)
+        {
+            mdl_watch_cells(first);
+            int guard = mdl_emit(c, MDL_OP_GUARD, 0, form, nullptr, mdl_value_builtin_set);
+            mdl_compile_expr(c, args->v.p.cdr->v.p.car);
+            int hops, slot;
+            if (mdl_lexical_address(c, arg1->v.a, &hops, &slot))
+            {
+                int insn = mdl_emit(c, MDL_OP_SETLOCAL, 0, form, arg1, nullptr, slot);
+                mdl_patch(c, insn, hops);
+            }
+            else
+            {
+                mdl_emit(c, MDL_OP_SET, 0, form, arg1);
+            }
+            mdl_patch(c, guard, mdl_here(c));
+            return true;
+        }
+        mdl_value_t *fsubrs[] = {
+            mdl_value_builtin_cond, mdl_value_builtin_and, mdl_value_builtin_or,
+            mdl_value_builtin_prog, mdl_value_builtin_repeat
+        };
+        for (mdl_value_t *builtin : fsubrs)
+        {
+            if (mdl_is_builtin(hint, builtin))
+            {
+                mdl_watch_cells(first);
+                return mdl_compile_fsubr(c, form, args, builtin, tail);
+            }
+        }
+    }
+
+    // FSUBRs and MACROs get their arguments unevaluated, leave them to
+    // the evaluator
+    if (segments || (hint && (hint->type == MDL_TYPE_FSUBR || hint->type == MDL_TYPE_MACRO)))
+    {
+        return false;
+    }
+
+    mdl_watch_cells(first);
+    int head_insn = mdl_emit(c, MDL_OP_CALLHEAD, 1, form);
+    for (mdl_value_t *cell = args; cell; cell = cell->v.p.cdr)
+    {
+        mdl_compile_expr(c, cell->v.p.car);
+    }
+    mdl_emit(c, tail ? MDL_OP_TAILCALL : MDL_OP_CALL, -nargs, form, nullptr, nullptr, nargs);
+    mdl_patch(c, head_insn, mdl_here(c));
+    return true;
+}
+
+static void mdl_compile_expr(mdl_compiler_t *c, mdl_value_t *expr, bool tail)
+{
+    if (mdl_self_evaluating(expr))
+    {
+        mdl_emit(c, MDL_OP_CONST, 1, nullptr, expr);
+    }
+    else if (expr->type != MDL_TYPE_FORM || !mdl_compile_form(c, expr, tail))
+    {
+        mdl_emit(c, MDL_OP_EVAL, 1, expr);
+    }
+}
+
+static mdl_code_t *mdl_finish_code(mdl_compiler_t *c)
+{
+    mdl_emit(c, MDL_OP_RETURN, 0);
+
+    size_t size = sizeof(mdl_code_t) + (c->insns.size() - 1) * sizeof(mdl_insn_t);
+    mdl_code_t *code = (mdl_code_t *)GC_MALLOC(size);
+    code->epoch = mdl_code_epoch;
+    code->maxdepth = c->maxdepth;
+    code->ninsns = c->insns.size();
+    std::memcpy(code->insns, c->insns.data(), c->insns.size() * sizeof(mdl_insn_t));
+    return code;
+}
+
+static mdl_code_t *mdl_compile_sequence(mdl_value_t *body, bool tail, const mdl_lexical_frame_t *frames)
+{
+    mdl_compiler_t c;
+    c.depth = c.maxdepth = 0;
+    c.frames = frames;
+
+    mdl_compile_exprs(&c, body, tail);
+    return mdl_finish_code(&c);
+}
+
+// A function whose argument list wants unevaluated arguments (quoted
+// atoms, "ARGS" or "CALL") must get the form
+static bool mdl_fargs_take_values(mdl_value_t *fargs)
+{
+    if (!fargs || fargs->type != MDL_TYPE_LIST)
+    {
+        return false;
+    }
+    for (mdl_value_t *cell = fargs->v.p.cdr; cell; cell = cell->v.p.cdr)
+    {
+        mdl_value_t *farg = cell->v.p.car;
+        if (farg->type == MDL_TYPE_LIST && farg->v.p.cdr)
+        {
+            mdl_watch_cells(farg->v.p.cdr);
+            farg = farg->v.p.cdr->v.p.car;
+        }
+        if (farg->type == MDL_TYPE_FORM)
+        {
+            return false;
+        }
+        if (farg->type == MDL_TYPE_STRING &&
+            (mdl_string_equal_cstr(&farg->v.s, "ARGS") ||
+             mdl_string_equal_cstr(&farg->v.s, "CALL")))
+        {
+            return false;
+        }
+    }
+    mdl_watch_cells(fargs->v.p.cdr);
+    return true;
+}
+
+mdl_code_t *mdl_function_code(mdl_value_t *applier)
+{
+    if (applier->pt != PRIMTYPE_LIST || !applier->v.p.cdr)
+    {
+        return nullptr;
+    }
+    mdl_value_t *key = applier->v.p.cdr;
+    mdl_code_slot_t *slot = mdl_code_slot(mdl_function_code_cache, key);
+    if (slot->key == key && slot->code->epoch == mdl_code_epoch)
+    {
+        return slot->code;
+    }
+
+    // the body starts after the argument list, as in mdl_apply_function
+    mdl_value_t *body = key->v.p.cdr;
+    if (!body)
+    {
+        return nullptr;
+    }
+    size_t mark = mdl_watch_log.size();
+    mdl_watch_cells(key);
+
+    mdl_value_t *fargs = key->v.p.car;
+    if (fargs->type == MDL_TYPE_ATOM)
+    {
+        fargs = body->v.p.car;
+    }
+    bool take_values = mdl_fargs_take_values(fargs);
+
+    // as bound by mdl_push_function_frame
+    mdl_lexical_frame_t frame;
+    frame.outer = nullptr;
+    mdl_argspec_t *spec = nullptr;
+    if (fargs->type == MDL_TYPE_LIST)
+    {
+        spec = mdl_fargs_spec(fargs, false);
+    }
+    if (spec && spec->bad)
+    {
+        spec = nullptr;
+    }
+    if (spec)
+    {
+        if (fargs != key->v.p.car)
+        {
+            frame.atoms.push_back(key->v.p.car->v.a);
+        }
+        for (int i = 0; i < spec->nslots; i++)
+        {
+            frame.atoms.push_back(spec->slots[i].atom);
+        }
+    }
+
+    // only mdl_apply_function runs this, and it takes tail calls
+    mdl_code_t *code = mdl_compile_sequence(body, true, spec ? &frame : nullptr);
+    code->apply_args = take_values;
+    mdl_fill_entry(slot, key, mark);
+    slot->code = code;
+    return code;
+}
+
+mdl_code_t *mdl_body_code(mdl_value_t *body)
+{
+    if (!body)
+    {
+        return nullptr;
+    }
+    mdl_code_slot_t *slot = mdl_code_slot(mdl_body_code_cache, body);
+    if (slot->key == body && slot->code->epoch == mdl_code_epoch)
+    {
+        return slot->code;
+    }
+    size_t mark = mdl_watch_log.size();
+    mdl_code_t *code = mdl_compile_sequence(body, false);
+    mdl_fill_entry(slot, body, mark);
+    slot->code = code;
+    return code;
+}
+
+// ends a parse with the error mdl_bind_args raises on reaching this
+// point of the list
+static bool mdl_argspec_error(std::vector<mdl_argspec_slot_t> &slots, int kind, const char *error, bool quoted = false)
+{
+    mdl_argspec_slot_t slot;
+    slot.kind = kind;
+    slot.quoted = quoted;
+    slot.atom = nullptr;
+    slot.default_val = nullptr;
+    slot.farg = nullptr;
+    slot.error = error;
+    slots.push_back(slot);
+    return false;
+}
+
+// The argument list as mdl_bind_args binds it.  A syntax error becomes
+// the last slot, so the arguments before it are bound (and evaluated)
+// before the error comes out, as they always were.  Returns false if
+// there is one
+static bool mdl_parse_fargs(mdl_value_t *fargs, bool auxonly, std::vector<mdl_argspec_slot_t> &slots)
+{
+    enum {
+        ARGSTATE_INITIAL, // looking for atoms or string
+        ARGSTATE_BIND,    // just got the bind, looking for one atom
+        ARGSTATE_ATOMS,   // looking for atoms or string other than BIND
+        ARGSTATE_CALL,    // looking for a single atom
+        ARGSTATE_OPTIONAL,// looking for atoms, 2 lists, or string
+        ARGSTATE_ARGS,    // looking for a single atom
+        ARGSTATE_TUPLE,   // looking for a single atom
+        ARGSTATE_ANONLY,  // No more args, looking for AUX or NAME
+        ARGSTATE_AUX,     // looking for atoms or 2-lists
+        ARGSTATE_NAME,    // looking for atom
+        ARGSTATE_NOMORE   // that's it, nothing else
+    }
+    argstate = auxonly ? ARGSTATE_AUX : ARGSTATE_INITIAL;
+
+    for (mdl_value_t *cell = fargs->v.p.cdr; cell; cell = cell->v.p.cdr)
+    {
+        mdl_value_t *farg = cell->v.p.car;
+        mdl_value_t *default_val = &mdl_value_unassigned;
+
+        if (farg->type == MDL_TYPE_LIST)
+        {
+            default_val = LITEM(farg, 1);
+            if (!default_val || LHASITEM(farg, 2))
+            {
+                return mdl_argspec_error(slots, MDL_ARGSPEC_ERROR, "Only lists allowed in arg lists are 2-lists");
+            }
+            farg = LITEM(farg, 0);
+            if (farg->type != MDL_TYPE_FORM && farg->type != MDL_TYPE_ATOM)
+            {
+                return mdl_argspec_error(slots, MDL_ARGSPEC_ERROR, "First element in 2-list must be atom or quoted atom");
+            }
+            if (argstate != ARGSTATE_OPTIONAL && argstate != ARGSTATE_AUX)
+            {
+                return mdl_argspec_error(slots, MDL_ARGSPEC_CALL_ERROR, "2-lists allowed only in OPTIONAL or AUX sections");
+            }
+            mdl_watch_cells(cell->v.p.car->v.p.cdr);
+        }
+
+        if (farg->type == MDL_TYPE_STRING)
+        {
+            if (mdl_string_equal_cstr(&farg->v.s, "BIND"))
+            {
+                if (argstate != ARGSTATE_INITIAL)
+                {
+                    return mdl_argspec_error(slots, MDL_ARGSPEC_ERROR, "BIND must be first thing in argument list");
+                }
+                argstate = ARGSTATE_BIND;
+            }
+            else if (mdl_string_equal_cstr(&farg->v.s, "CALL"))
+            {
+                // an argument before it is either missing, which is
+                // an error of its own, or bound, which is this one
+                bool after_argument = false;
+                for (const mdl_argspec_slot_t &prev : slots)
+                {
+                    after_argument = after_argument || prev.kind == MDL_ARGSPEC_REQUIRED;
+                }
+                if ((argstate != ARGSTATE_INITIAL && argstate != ARGSTATE_ATOMS) || after_argument)
+                {
+                    return mdl_argspec_error(slots, MDL_ARGSPEC_ERROR, "CALL must be the only argment-gatherer");
+                }
+                argstate = ARGSTATE_CALL;
+            }
+            else if (mdl_string_equal_cstr(&farg->v.s, "OPT") ||
+                     mdl_string_equal_cstr(&farg->v.s, "OPTIONAL"))
+            {
+                if (argstate != ARGSTATE_INITIAL && argstate != ARGSTATE_ATOMS)
+                {
+                    return mdl_argspec_error(slots, MDL_ARGSPEC_ERROR, "OPTIONAL in wrong place in argument string");
+                }
+                argstate = ARGSTATE_OPTIONAL;
+            }
+            else if (mdl_string_equal_cstr(&farg->v.s, "ARGS"))
+            {
+                if (argstate != ARGSTATE_INITIAL &&
+                    argstate != ARGSTATE_ATOMS &&
+                    argstate != ARGSTATE_OPTIONAL)
+                {
+                    return mdl_argspec_error(slots, MDL_ARGSPEC_ERROR, "ARGS in wrong place in argument string");
+                }
+                argstate = ARGSTATE_ARGS;
+            }
+            else if (mdl_string_equal_cstr(&farg->v.s, "TUPLE"))
+            {
+                if (argstate != ARGSTATE_INITIAL &&
+                    argstate != ARGSTATE_ATOMS &&
+                    argstate != ARGSTATE_OPTIONAL)
+                {
+                    return mdl_argspec_error(slots, MDL_ARGSPEC_ERROR, "TUPLE in wrong place in argument string");
+                }
+                argstate = ARGSTATE_TUPLE;
+            }
+            else if (mdl_string_equal_cstr(&farg->v.s, "AUX") ||
+                     mdl_string_equal_cstr(&farg->v.s, "EXTRA"))
+            {
+                if (argstate != ARGSTATE_INITIAL &&
+                    argstate != ARGSTATE_ATOMS &&
+                    argstate != ARGSTATE_OPTIONAL &&
+                    argstate != ARGSTATE_ANONLY)
+                {
+                    return mdl_argspec_error(slots, MDL_ARGSPEC_ERROR, "AUX/EXTRA in wrong place in argument string");
+                }
+                argstate = ARGSTATE_AUX;
+            }
+            else if (mdl_string_equal_cstr(&farg->v.s, "NAME") ||
+                     mdl_string_equal_cstr(&farg->v.s, "ACT"))
+            {
+                if (argstate != ARGSTATE_INITIAL &&
+                    argstate != ARGSTATE_ATOMS &&
+                    argstate != ARGSTATE_OPTIONAL &&
+                    argstate != ARGSTATE_ANONLY &&
+                    argstate != ARGSTATE_AUX)
+                {
+                    return mdl_argspec_error(slots, MDL_ARGSPEC_ERROR, "NAME/ACT in wrong place in argument string");
+                }
+                argstate = ARGSTATE_NAME;
+            }
+            continue;
+        }
+
+        mdl_argspec_slot_t slot;
+        slot.quoted = false;
+        slot.default_val = default_val;
+        slot.farg = farg;
+        slot.error = nullptr;
+        if (farg->type == MDL_TYPE_FORM)
+        {
+            mdl_value_t *atom = LITEM(farg, 1);
+            mdl_value_t *quote = LITEM(farg, 0);
+            if (!atom ||
+                atom->type != MDL_TYPE_ATOM ||
+                LHASITEM(farg, 2) ||
+                !mdl_value_equal(quote, mdl_value_atom_quote))
+            {
+                return mdl_argspec_error(slots, MDL_ARGSPEC_ERROR, "FORM in arg list may only be <QUOTE atom>");
+            }
+            if (argstate != ARGSTATE_INITIAL &&
+                argstate != ARGSTATE_ATOMS &&
+                argstate != ARGSTATE_OPTIONAL)
+            {
+                return mdl_argspec_error(slots, MDL_ARGSPEC_ERROR, "Unexpected quoted ATOM in formal argument list", true);
+            }
+            slot.quoted = true;
+            mdl_watch_cells(farg->v.p.cdr);
+            farg = atom;
+        }
+        else if (farg->type != MDL_TYPE_ATOM)
+        {
+            continue;
+        }
+        slot.atom = farg->v.a;
+
+        switch (argstate)
+        {
+        case ARGSTATE_INITIAL:
+        case ARGSTATE_ATOMS:
+            slot.kind = MDL_ARGSPEC_REQUIRED;
+            break;
+        case ARGSTATE_OPTIONAL:
+            slot.kind = MDL_ARGSPEC_OPTIONAL;
+            break;
+        case ARGSTATE_BIND:
+            slot.kind = MDL_ARGSPEC_BIND;
+            argstate = ARGSTATE_ATOMS;
+            break;
+        case ARGSTATE_CALL:
+            slot.kind = MDL_ARGSPEC_CALL;
+            argstate = ARGSTATE_ANONLY;
+            break;
+        case ARGSTATE_ARGS:
+            slot.kind = MDL_ARGSPEC_ARGS;
+            argstate = ARGSTATE_ANONLY;
+            break;
+        case ARGSTATE_TUPLE:
+            slot.kind = MDL_ARGSPEC_TUPLE;
+            argstate = ARGSTATE_ANONLY;
+            break;
+        case ARGSTATE_NAME:
+            slot.kind = MDL_ARGSPEC_NAME;
+            argstate = ARGSTATE_NOMORE;
+            break;
+        case ARGSTATE_AUX:
+            slot.kind = MDL_ARGSPEC_AUX;
+            break;
+        default:
+            return mdl_argspec_error(slots, MDL_ARGSPEC_ERROR, "Unexpected ATOM in formal argument list");
+        }
+        slots.push_back(slot);
+    }
+    return true;
+}
+
+mdl_argspec_t *mdl_fargs_spec(mdl_value_t *fargs, bool auxonly)
+{
+    mdl_value_t *key = fargs->v.p.cdr;
+    if (!key)
+    {
+        return &mdl_argspec_empty;
+    }
+    mdl_argspec_cache_slot_t *slot = &mdl_argspec_cache[mdl_code_hash(key)];
+    if (slot->key == key && slot->auxonly == auxonly && slot->epoch == mdl_code_epoch)
+    {
+        return slot->spec;
+    }
+
+    size_t mark = mdl_watch_log.size();
+    std::vector<mdl_argspec_slot_t> slots;
+    bool bad = !mdl_parse_fargs(fargs, auxonly, slots);
+    size_t n = slots.size();
+    mdl_argspec_t *spec = (mdl_argspec_t *)GC_MALLOC(sizeof(mdl_argspec_t) + (n ? n - 1 : 0) * sizeof(mdl_argspec_slot_t));
+    spec->epoch = mdl_code_epoch;
+    spec->auxonly = auxonly;
+    spec->bad = bad;
+    spec->nslots = (int)n;
+    std::copy(slots.begin(), slots.end(), spec->slots);
+    mdl_watch_cells(key);
+    mdl_fill_entry(slot, key, mark);
+    slot->spec = spec;
+    slot->auxonly = auxonly;
+    slot->epoch = mdl_code_epoch;
+    return spec;
+}
+
+mdl_value_t *mdl_expand_form(mdl_value_t *macro, mdl_value_t *form)
+{
+    mdl_value_t *key = form->v.p.cdr;
+    mdl_expansion_slot_t *slot = &mdl_expansion_cache[mdl_code_hash(key)];
+    if (slot->key == key && slot->macro == macro && slot->epoch == mdl_code_epoch &&
+        slot->global_epoch == mdl_global_epoch)
+    {
+        return slot->expansion;
+    }
+
+    bool read_globals = true;
+    unsigned global_epoch = mdl_global_epoch;
+    mdl_value_t *expansion = mdl_internal_expand(form, &read_globals);
+    if (read_globals || global_epoch != mdl_global_epoch)
+    {
+        return expansion;
+    }
+    size_t mark = mdl_watch_log.size();
+    mdl_watch_structure(form);
+    mdl_watch_structure(macro);
+    mdl_fill_entry(slot, key, mark);
+    slot->macro = macro;
+    slot->expansion = expansion;
+    slot->epoch = mdl_code_epoch;
+    slot->global_epoch = global_epoch;
+    return expansion;
+}
+
+// the slot a LOCAL or SETLOCAL instruction addresses, if it holds the
+// atom.  When it doesn't (the frames aren't the ones the code was
+// compiled for, or bound in another order) the caller looks the atom
+// up the long way
+static inline mdl_local_symbol_t *mdl_lexical_slot(const mdl_insn_t *insn)
+{
+    mdl_frame_t *frame = cur_frame;
+    for (int hops = insn->target; hops && frame; hops--)
+    {
+        frame = frame->prev_frame;
+    }
+    if (frame && insn->n < frame->nsyms && frame->inline_syms[insn->n].atom == insn->val->v.a)
+    {
+        return &frame->inline_syms[insn->n];
+    }
+    return nullptr;
+}
+
+mdl_value_t *mdl_run_code(mdl_code_t *code)
+{
+    // the stack is on the C stack so the collector sees it, and so
+    // that RETURN and AGAIN can longjmp out of here
+    mdl_value_t **stack = (mdl_value_t **)alloca((code->maxdepth + 1) * sizeof(mdl_value_t *));
+    mdl_value_t **sp = stack;
+    const mdl_insn_t *insns = code->insns;
+    const mdl_insn_t *pc = insns;
+
+    for (;;)
+    {
+        switch (pc->op)
+        {
+        case MDL_OP_CONST:
+            *sp++ = pc->val;
+            pc++;
+            break;
+        case MDL_OP_EVAL:
+            *sp++ = mdl_eval(pc->form, false);
+            pc++;
+            break;
+        case MDL_OP_LOCAL:
+        {
+            // LVAL was its SUBR when this last ran, and nothing has
+            // changed a GVAL that was an applier since
+            mdl_local_symbol_t *sym;
+            if (pc->epoch == mdl_global_epoch && (sym = mdl_lexical_slot(pc)) &&
+                sym->binding && sym->binding->type != MDL_TYPE_UNBOUND)
+            {
+                *sp++ = sym->binding;
+                pc++;
+                break;
+            }
+        }
+        // FALLTHROUGH
+        case MDL_OP_LVAL:
+        case MDL_OP_GVAL:
+        {
+            mdl_value_t *applier = mdl_form_applier(pc->form);
+            mdl_value_t *result = nullptr;
+            if (mdl_is_builtin(applier, pc->aux))
+            {
+                mdl_local_symbol_t *sym;
+                if (pc->op == MDL_OP_LOCAL && (sym = mdl_lexical_slot(pc)))
+                {
+                    // only a GVAL is covered by the epoch
+                    mdl_value_t *head = pc->form->v.p.cdr->v.p.car;
+                    if (mdl_global_symbol_lookup(head->v.a) == applier)
+                    {
+                        pc->epoch = mdl_global_epoch;
+                    }
+                    result = sym->binding;
+                }
+                else if (pc->op != MDL_OP_GVAL)
+                {
+                    result = mdl_local_symbol_lookup(pc->val->v.a, cur_frame);
+                }
+                else
+                {
+                    result = mdl_global_symbol_lookup(pc->val->v.a);
+                }
+            }
+            // let the SUBR report unbound variables
+            if (!result || result->type == MDL_TYPE_UNBOUND)
+            {
+                result = mdl_internal_apply(applier, pc->form, false);
+            }
+            *sp++ = result;
+            pc++;
+            break;
+        }
+        case MDL_OP_GUARD:
+        {
+            mdl_value_t *applier = mdl_form_applier(pc->form);
+            if (mdl_is_builtin(applier, pc->aux))
+            {
+                pc++;
+            }
+            else
+            {
+                *sp++ = mdl_internal_apply(applier, pc->form, false);
+                pc = insns + pc->target;
+            }
+            break;
+        }
+        case MDL_OP_CALLHEAD:
+        {
+            mdl_value_t *applier = mdl_form_applier(pc->form);
+            mdl_code_t *fcode;
+            if (!(MDL_TYPE_FLAGS(applier->type) & MDL_TYPE_FLAG_APPLYTYPE) &&
+                (applier->type == MDL_TYPE_SUBR ||
+                 (applier->type == MDL_TYPE_FUNCTION &&
+                  (fcode = mdl_function_code(applier)) &&
+                  fcode->apply_args)))
+            {
+                *sp++ = applier;
+                pc++;
+            }
+            else
+            {
+                *sp++ = mdl_internal_apply(applier, pc->form, false);
+                pc = insns + pc->target;
+            }
+            break;
+        }
+        case MDL_OP_TAILCALL:
+            if (sp[-pc->n - 1]->type == MDL_TYPE_FUNCTION)
+            {
+                mdl_value_t *rest = nullptr;
+                sp -= pc->n;
+                for (int i = pc->n - 1; i >= 0; i--)
+                {
+                    rest = mdl_cons_internal(sp[i], rest);
+                }
+                rest = mdl_cons_internal(pc->form->v.p.cdr->v.p.car, rest);
+                mdl_tail_applier = sp[-1];
+                mdl_tail_apply_to = mdl_make_list(rest);
+                return &mdl_value_tail_call;
+            }
+            // FALLTHROUGH
+        case MDL_OP_CALL:
+        {
+            mdl_value_t *rest = nullptr;
+            sp -= pc->n;
+            mdl_value_t *applier = sp[-1];
+            if (applier->type == MDL_TYPE_SUBR)
+            {
+                size_t argtop = mdl_argstack_top;
+                mdl_value_t *arglist = mdl_argstack_make_list(nullptr);
+                mdl_value_t *lastitem = arglist;
+                for (int i = 0; i < pc->n; i++)
+                {
+                    lastitem->v.p.cdr = mdl_argstack_cons(sp[i], nullptr);
+                    lastitem = lastitem->v.p.cdr;
+                }
+                sp[-1] = mdl_apply_built_in(applier, pc->form, arglist);
+                mdl_argstack_top = argtop;
+            }
+            else
+            {
+                for (int i = pc->n - 1; i >= 0; i--)
+                {
+                    rest = mdl_cons_internal(sp[i], rest);
+                }
+                // FUNCTIONs get the name they were called by, for FRAME
+                rest = mdl_cons_internal(pc->form->v.p.cdr->v.p.car, rest);
+                sp[-1] = mdl_apply_function(applier, mdl_make_list(rest), true);
+            }
+            pc++;
+            break;
+        }
+        case MDL_OP_FSUBR:
+        {
+            mdl_value_t *applier = mdl_form_applier(pc->form);
+            if (mdl_is_builtin(applier, pc->aux))
+            {
+                mdl_value_t *arglist = mdl_make_list(pc->form->v.p.cdr->v.p.cdr);
+                *sp++ = mdl_apply_built_in(applier, pc->form, arglist, pc->code);
+            }
+            else
+            {
+                *sp++ = mdl_internal_apply(applier, pc->form, false);
+            }
+            pc++;
+            break;
+        }
+        case MDL_OP_SET:
+            sp[-1] = mdl_set_lval(pc->val->v.a, sp[-1], cur_frame);
+            pc++;
+            break;
+        case MDL_OP_SETLOCAL:
+        {
+            mdl_local_symbol_t *sym = mdl_lexical_slot(pc);
+            if (sym)
+            {
+                sym->binding = sp[-1];
+            }
+            else
+            {
+                sp[-1] = mdl_set_lval(pc->val->v.a, sp[-1], cur_frame);
+            }
+            pc++;
+            break;
+        }
+        case MDL_OP_PROG:
+            *sp++ = mdl_internal_prog_repeat_bind(pc->form, true, pc->n != 0, pc->code);
+            pc++;
+            break;
+        case MDL_OP_POP:
+            sp--;
+            pc++;
+            break;
+        case MDL_OP_JUMP:
+            pc = insns + pc->target;
+            break;
+        case MDL_OP_JUMP_FALSE:
+            if (!mdl_is_true(sp[-1]))
+            {
+                pc = insns + pc->target;
+            }
+            else
+            {
+                pc++;
+            }
+            break;
+        case MDL_OP_JUMP_TRUE:
+            if (mdl_is_true(sp[-1]))
+            {
+                pc = insns + pc->target;
+            }
+            else
+            {
+                pc++;
+            }
+            break;
+        case MDL_OP_RETURN:
+            return sp[-1];
+        default:
+            mdl_error("Bad opcode in compiled code");
+        }
+    }
+}
@@ -0,0 +1,129 @@
+/*****************************************************************************/
+/*    'Confusion', a MDL intepreter                                         */
+/*    Copyright 2009 Matthew T. Russotto                                    */
+/*                                                                          */
+/*    This program is free software: you can redistribute it and/or modify  */
+/*    it under the terms of the GNU General Public License as published by  */
+/*    the Free Software Foundation, version 3 of 29 June 2007.              */
+/*                                                                          */
+/*    This program is distributed in the hope that it will be useful,       */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/*    GNU General Public License for more details.                          */
+/*                                                                          */
+/*    You should have received a copy of the GNU General Public License     */
+/*    along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*****************************************************************************/
+
+#ifndef MDL_COMPILE_HPP_
+#define MDL_COMPILE_HPP_
+
+// Bytecode for FUNCTION, PROG and REPEAT bodies.  This is not the MDL
+// compiler; bodies are translated on first use, and everything the
+// translator doesn't understand is left to the list evaluator.
+
+enum mdl_opcode_t
+{
+    MDL_OP_CONST,       // push val
+    MDL_OP_EVAL,        // push EVAL of form
+    MDL_OP_LVAL,        // push LVAL of atom val (form if not plain LVAL)
+    MDL_OP_LOCAL,       // LVAL, from slot n of the frame target frames
+                        // up if atom val is bound there
+    MDL_OP_GVAL,        // push GVAL of atom val (form if not plain GVAL)
+    MDL_OP_GUARD,       // continue if form applies builtin aux, else
+                        // push the applied form and jump to target
+    MDL_OP_CALLHEAD,    // push applier of form, or push applied form and
+                        // jump to target
+    MDL_OP_CALL,        // apply applier below n args to them
+    MDL_OP_TAILCALL,    // CALL, but a FUNCTION is left for the caller
+                        // to apply, see mdl_value_tail_call
+    MDL_OP_FSUBR,       // run code in a frame for builtin aux, if form
+                        // applies it, else push the applied form
+    MDL_OP_SET,         // SET atom val to top of stack
+    MDL_OP_SETLOCAL,    // SET, to slot n of the frame target frames up
+                        // if atom val is bound there
+    MDL_OP_PROG,        // run code as PROG (n = 0) or REPEAT (n = 1)
+    MDL_OP_POP,
+    MDL_OP_JUMP,
+    MDL_OP_JUMP_FALSE,  // jump if top of stack is false, keeping it
+    MDL_OP_JUMP_TRUE,   // jump if top of stack is true, keeping it
+    MDL_OP_RETURN
+};
+
+struct mdl_code_t;
+
+struct mdl_insn_t
+{
+    int op;
+    int n;
+    int target;
+    mdl_value_t *val;
+    mdl_value_t *aux;
+    mdl_value_t *form; // original expression
+    mdl_code_t *code;
+    mutable unsigned epoch; // LOCAL: mdl_global_epoch LVAL was last checked in
+};
+
+struct mdl_code_t
+{
+    unsigned epoch;
+    bool apply_args; // function may be called with evaluated arguments
+    int maxdepth;
+    int ninsns;
+    mdl_insn_t insns[1];
+};
+
+// A FUNCTION's or PROG's argument list, parsed once for mdl_bind_args.
+// A list with a syntax error is bad, and its last slot raises the error
+enum mdl_argspec_kind_t
+{
+    MDL_ARGSPEC_REQUIRED,   // next argument, evaluated unless quoted
+    MDL_ARGSPEC_OPTIONAL,   // next argument, or EVAL of the default
+    MDL_ARGSPEC_BIND,       // ENVIRONMENT of the caller
+    MDL_ARGSPEC_CALL,       // the calling form
+    MDL_ARGSPEC_ARGS,       // LIST of the remaining arguments
+    MDL_ARGSPEC_TUPLE,      // TUPLE of the remaining arguments, evaluated
+    MDL_ARGSPEC_NAME,       // ACTIVATION of the new frame
+    MDL_ARGSPEC_AUX,        // EVAL of the default
+    MDL_ARGSPEC_ERROR,      // mdl_error of error
+    MDL_ARGSPEC_CALL_ERROR  // mdl_call_error_ext of error
+};
+
+struct mdl_argspec_slot_t
+{
+    int kind;
+    bool quoted;
+    atom_t *atom;
+    mdl_value_t *default_val; // &mdl_value_unassigned if none
+    mdl_value_t *farg;        // atom or QUOTE form, for error messages
+    const char *error;        // what an error slot raises
+};
+
+struct mdl_argspec_t
+{
+    unsigned epoch;
+    bool auxonly;
+    bool bad;                 // binding ends in an error
+    int nslots;
+    mdl_argspec_slot_t slots[1];
+};
+
+extern unsigned mdl_code_epoch;
+
+// mdl_run_code returns this when the code ends by calling a FUNCTION.
+// The FUNCTION and its arguments are in mdl_tail_applier and
+// mdl_tail_apply_to, and every frame pushed since mdl_apply_function
+// ran the body is left on the stack for it to pop when the call is done
+extern mdl_value_t mdl_value_tail_call;
+extern mdl_value_t *mdl_tail_applier;
+extern mdl_value_t *mdl_tail_apply_to;
+
+mdl_code_t *mdl_function_code(mdl_value_t *applier);
+mdl_code_t *mdl_body_code(mdl_value_t *body);
+mdl_value_t *mdl_run_code(mdl_code_t *code);
+mdl_argspec_t *mdl_fargs_spec(mdl_value_t *fargs, bool auxonly);
+mdl_value_t *mdl_expand_form(mdl_value_t *macro, mdl_value_t *form);
+void mdl_invalidate_code();
+void mdl_code_cell_changed(const mdl_value_t *cell);
+
+#endif // MDL_COMPILE_HPP_
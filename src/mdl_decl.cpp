@@ -19,7 +19,6 @@
 
 // MDL DECL checking... work in progress
 // some errors are wrongly generic at the moment
-#define RATOM(X) mdl_get_atom_from_oblist(#X, mdl_value_root_oblist)
 
 #define DECL_ERROR(MSG)                      \
     do {                                     \
@@ -43,20 +42,20 @@ mdl_value_t *mdl_check_decl(mdl_value_t *val, mdl_value_t *decl, bool *error)
         standin = false;
         if (decl->type == MDL_TYPE_ATOM)
         {
-            if (mdl_value_equal(decl, RATOM(ANY)))
+            if (mdl_value_equal(decl, mdl_value_atom_any))
             {
                 return mdl_value_T;
             }
-            if (mdl_value_equal(decl, RATOM(STRUCTURED)))
+            if (mdl_value_equal(decl, mdl_value_atom_structured))
             {
                 return mdl_boolean_value(mdl_primtype_structured(decl->pt));
             }
-            if (mdl_value_equal(decl, RATOM(LOCATIVE)))
+            if (mdl_value_equal(decl, mdl_value_atom_locative))
             {
                 return mdl_boolean_value(decl->pt >= PRIMTYPE_LOCA &&
                                          decl->pt <= PRIMTYPE_LOCV);
             }
-            if (mdl_value_equal(decl, RATOM(APPLICABLE)))
+            if (mdl_value_equal(decl, mdl_value_atom_applicable))
             {
                 return mdl_boolean_value(mdl_type_is_applicable(mdl_apply_type(decl->type)));
             }
@@ -72,7 +71,7 @@ mdl_value_t *mdl_check_decl(mdl_value_t *val, mdl_value_t *decl, bool *error)
                 }
                 return mdl_boolean_value(val->type == typenum);
             }
-            decl = mdl_internal_eval_getprop(decl, RATOM(DECL));
+            decl = mdl_internal_eval_getprop(decl, mdl_value_atom_decl);
             if (!decl)
             {
                 DECL_ERROR("BAD-TYPE-SPECIFICATION1");
@@ -91,7 +90,7 @@ mdl_value_t *mdl_check_decl(mdl_value_t *val, mdl_value_t *decl, bool *error)
         }
 
         // quoted value
-        if (mdl_value_equal(firstitem, RATOM(QUOTE)))
+        if (mdl_value_equal(firstitem, mdl_value_atom_quote))
         {
             mdl_value_t *type = LITEM(decl, 1);
             if (!type || LHASITEM(decl, 2))
@@ -102,7 +101,7 @@ mdl_value_t *mdl_check_decl(mdl_value_t *val, mdl_value_t *decl, bool *error)
         }
 
         // primtype
-        if (mdl_value_equal(firstitem, RATOM(PRIMTYPE)))
+        if (mdl_value_equal(firstitem, mdl_value_atom_primtype))
         {
             mdl_value_t *type = LITEM(decl, 1);
             if (!type)
@@ -124,7 +123,7 @@ mdl_value_t *mdl_check_decl(mdl_value_t *val, mdl_value_t *decl, bool *error)
         }
 
         // OR
-        if (mdl_value_equal(firstitem, RATOM(OR)))
+        if (mdl_value_equal(firstitem, mdl_value_atom_or))
         {
             mdl_value_t *typecursor = LREST(decl, 1);
             if (!typecursor)
@@ -223,7 +222,7 @@ mdl_check_struct_decl(mdl_value_t *val, mdl_value_t *decl, bool *error)
                     }
                 }
             }
-            else if (mdl_value_equal(firstitem, RATOM(REST)))
+            else if (mdl_value_equal(firstitem, mdl_value_atom_rest))
             {
                 if (declcursor->v.p.cdr)
                 {
@@ -249,7 +248,7 @@ mdl_check_struct_decl(mdl_value_t *val, mdl_value_t *decl, bool *error)
                     }
                 }
             }
-            else if (mdl_value_equal(firstitem, RATOM(OPT)))
+            else if (mdl_value_equal(firstitem, mdl_value_atom_opt))
             {
                 if (optfound)
                 {
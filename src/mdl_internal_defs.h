@@ -32,9 +32,7 @@ struct mdl_local_symbol_t
 {
     atom_t *atom;
     mdl_value_t *binding;
-#ifdef CACHE_LOCAL_SYMBOLS
-    mdl_local_symbol_t *prev_binding;
-#endif
+    mdl_local_symbol_t *prev_binding; // the one this shadows, while installed
 };
 
 #define ALIGN_MDL_INT(x) (((((intptr_t)x) + sizeof(MDL_INT) - 1)/sizeof(MDL_INT)) * sizeof(MDL_INT))
@@ -73,10 +71,16 @@ using symbol_table = std::map<const atom_t *, SymbolType,
     gc_allocator<std::pair<const atom_t * const, SymbolType>>
 >;
 
+template<typename SymbolType>
+using symbol_hash_table = std::unordered_map<const atom_t *, SymbolType,
+    std::hash<const atom_t *>, std::equal_to<const atom_t *>,
+    gc_allocator<std::pair<const atom_t * const, SymbolType>>
+>;
+
 }   // namesapce mdl
 
-using mdl_symbol_table_t = mdl::symbol_table<mdl_symbol_t>;
-using mdl_local_symbol_table_t = mdl::symbol_table<mdl_local_symbol_t>;
+using mdl_global_atoms_t = std::vector<atom_t *, gc_allocator<atom_t *>>;
+using mdl_local_symbol_table_t = mdl::symbol_hash_table<mdl_local_symbol_t>;
 
 struct mdl_assoc_key_t
 {
@@ -84,6 +88,21 @@ struct mdl_assoc_key_t
     mdl_value_t *indicator;
 };
 
+// An ATOM's properties under ATOM indicators, kept with the atom
+// instead of in the association table; see mdl_assoc.cpp
+struct mdl_atom_prop_t
+{
+    mdl_assoc_key_t key;
+    mdl_value_t *value;
+};
+
+struct mdl_atom_props_t
+{
+    int nprops;
+    int maxprops;
+    mdl_atom_prop_t props[1];
+};
+
 extern struct mdl_assoc_table_t *mdl_assoc_table;
 
 typedef mdl_value_t *(*mdl_evaluator_t)(mdl_value_t *cdr);
@@ -92,20 +111,46 @@ typedef mdl_value_t *(*mdl_evaluator_t)(mdl_value_t *cdr);
 #define MDL_FRAME_FLAGS_ACTIVATION  2  /* a frame for a function, prog, repeat, bind, or map */
 #define MDL_FRAME_FLAGS_NAMED_FUNC  4  /* a frame for a named function */
 #define MDL_FRAME_FLAGS_UNWIND    0x100  /* unwind frame -- apply second arg */
+#define MDL_FRAME_FLAGS_POOLED    0x200  /* frame from the free list */
+#define MDL_FRAME_FLAGS_CAPTURED  0x400  /* may be referenced after it returns */
+#define MDL_FRAME_FLAGS_CATCH     0x800  /* jumps here are thrown, not longjmp'd */
+#define MDL_FRAME_FLAGS_BOUND    0x1000  /* its bindings are installed in the atoms */
+#define MDL_FRAME_FLAGS_LPROG    0x2000  /* a prog or repeat -- the default for RETURN and AGAIN */
 
 // on OS X, setjmp is dog slow
 #define mdl_setjmp _setjmp
 #define mdl_longjmp _longjmp
 
+// Most frames bind a few atoms at most; those bindings are kept in the
+// frame itself, and only the rest go in a table
+#define MDL_FRAME_INLINE_SYMS 4
+
 struct mdl_frame_t
 {
     struct mdl_frame_t *prev_frame;
-    jmp_buf interp_frame;
+    // set only by the few functions that longjmp to their frame (LISTEN,
+    // MAPF/MAPR, FLATSIZE, FLOAD, the top level), to a jmp_buf in
+    // their own C frame
+    jmp_buf *interp_frame;
     mdl_value_t *result; // for RETURN
-    mdl_local_symbol_table_t *syms;
+    int nsyms; // bindings used in inline_syms
+    mdl_local_symbol_t inline_syms[MDL_FRAME_INLINE_SYMS];
+    mdl_local_symbol_table_t *syms; // bindings past the inline ones
     mdl_value_t *subr; // the atom containing the subroutine being applied
     mdl_value_t *args; // Argument tuple
     unsigned frame_flags;
+    struct mdl_code_t *tail_code; // what to rerun if left behind by a tail call
+    unsigned depth; // frames below this one
+    unsigned kept; // of those, frames kept only for a tail call's sake
+};
+
+// Frames flagged MDL_FRAME_FLAGS_CATCH have no jmp_buf set up; the
+// function that pushed them catches this instead.  Nothing is paid for
+// it unless a jump is actually made.
+struct mdl_frame_jump_t
+{
+    mdl_frame_t *frame;
+    int value;
 };
 
 typedef mdl_value_t *mdl_built_in_proc_t(mdl_value_t *form, mdl_value_t *args);
@@ -134,6 +179,17 @@ using mdl_type_table_t = traceable_vector<mdl_type_table_entry_t>;
 
 extern mdl_type_table_t mdl_type_table;
 
+// One byte per type, so eval, apply and print can tell whether a type
+// needs anything special without going to the type table.  Indexed by
+// the type of a real value, which is always in range.
+#define MDL_TYPE_FLAG_EVALTYPE    0x01  /* has an EVALTYPE */
+#define MDL_TYPE_FLAG_APPLYTYPE   0x02  /* has an APPLYTYPE */
+#define MDL_TYPE_FLAG_PRINTTYPE   0x04  /* has a PRINTTYPE */
+#define MDL_TYPE_FLAG_SELF_EVAL   0x08  /* EVAL returns the object itself */
+#define MDL_TYPE_FLAG_STRUCTURED  0x10  /* structured primtype */
+extern std::vector<unsigned char> mdl_type_flags;
+#define MDL_TYPE_FLAGS(t) (mdl_type_flags[t])
+
 
 struct atom_t
 {
@@ -141,10 +197,10 @@ struct atom_t
     int typenum;
 //    char pname[1]; //the pname of an atom is NUL terminated even in real MDL
     char *pname; //the pname of an atom is NUL terminated even in real MDL
-#ifdef CACHE_LOCAL_SYMBOLS
-    int bindid;
-    mdl_local_symbol_t *binding; // LOCAL binding
-#endif
+    mdl_local_symbol_t *binding; // innermost LOCAL binding, see mdl_rebind_frames
+    mdl_symbol_t *global; // GVAL cell, from the first SETG on
+    MDL_INT hash; // mdl_hash_pname(pname)
+    mdl_atom_props_t *props; // properties under ATOM indicators
 };
 
 // welcome to hell... err, I mean LISP
@@ -244,12 +300,36 @@ struct mdl_tuple_block_t
     mdl_value_t elements[1];
 };
 
-extern mdl_symbol_table_t global_syms;
+// every atom with a GVAL cell, so RESTORE can take them away
+extern mdl_global_atoms_t global_syms;
+// bumped whenever any global binding changes, invalidating cached
+// appliers
+extern unsigned mdl_global_epoch;
+#define MDL_BUMP_GLOBAL_EPOCH() ((++mdl_global_epoch)?mdl_global_epoch:(++mdl_global_epoch))
+// counts calls of mdl_global_symbol_lookup, so a MACRO expansion can
+// tell whether it read any GVAL
+extern size_t mdl_global_reads;
 
 //extern mdl_type_table_entry_t mdl_built_in_type_table[];
 extern mdl_built_in_table_t built_in_table;
 extern mdl_frame_t *cur_frame;
 extern mdl_frame_t *initial_frame;
+// top of the SUBR argument stack; save it before building an argument
+// list there and put it back after the call
+extern size_t mdl_argstack_top;
+// C stack address below which recursion is a CONTROL-STACK-OVERFLOW.
+// Pushing a frame checks it; recursion over nested structures that
+// pushes no frames (EVAL, printing, =?) checks with mdl_check_stack
+extern uintptr_t mdl_stack_limit;
+void mdl_stack_overflow(uintptr_t sp);
+inline void mdl_check_stack()
+{
+    uintptr_t sp = (uintptr_t)__builtin_frame_address(0);
+    if (sp < mdl_stack_limit)
+    {
+        mdl_stack_overflow(sp);
+    }
+}
 #define cur_process_initial_frame initial_frame // no process support
 
 extern atom_t *atom_lastprog;
@@ -264,6 +344,33 @@ extern mdl_value_t *mdl_value_atom_lastprog;
 extern mdl_value_t *mdl_value_atom_lastmap;
 extern mdl_value_t *mdl_value_atom_default;
 extern mdl_value_t *mdl_value_T;
+extern mdl_value_t *mdl_value_atom_lval;
+extern mdl_value_t *mdl_value_atom_gval;
+extern mdl_value_t *mdl_value_atom_quote;
+extern mdl_value_t *mdl_value_atom_comment;
+extern mdl_value_t *mdl_value_atom_toplevel;
+extern mdl_value_t *mdl_value_atom_inchan;
+extern mdl_value_t *mdl_value_atom_outchan;
+extern mdl_value_t *mdl_value_atom_parse_string;
+extern mdl_value_t *mdl_value_atom_parse_table;
+extern mdl_value_t *mdl_value_atom_read_table;
+extern mdl_value_t *mdl_value_atom_last_out;
+extern mdl_value_t *mdl_value_atom_close;
+extern mdl_value_t *mdl_value_atom_read;
+extern mdl_value_t *mdl_value_atom_terpri;
+extern mdl_value_t *mdl_value_atom_print;
+extern mdl_value_t *mdl_value_atom_any;
+extern mdl_value_t *mdl_value_atom_structured;
+extern mdl_value_t *mdl_value_atom_locative;
+extern mdl_value_t *mdl_value_atom_applicable;
+extern mdl_value_t *mdl_value_atom_decl;
+extern mdl_value_t *mdl_value_atom_primtype;
+extern mdl_value_t *mdl_value_atom_or;
+extern mdl_value_t *mdl_value_atom_rest;
+extern mdl_value_t *mdl_value_atom_opt;
+extern mdl_value_t *mdl_value_atom_l_level;
+extern mdl_value_t *mdl_value_atom_l_err;
+extern mdl_value_t *mdl_value_atom_int_level;
 extern mdl_value_t mdl_value_false;
 extern mdl_value_t mdl_value_unassigned;
 extern mdl_value_t *mdl_static_block_stack;
@@ -352,6 +459,7 @@ enum
 {
     ICHANNEL_AT_EOF = 1,
     ICHANNEL_HAS_LOOKAHEAD = 2,
+    ICHANNEL_NO_COMMENTS = 4,   // reader discards comments
 };
 
 struct charinfo_t
@@ -380,6 +488,8 @@ primtype_t mdl_type_primtype(int typenum);
 atom_t *mdl_type_atom(int typenum);
 bool mdl_type_is_applicable(int type);
 bool mdl_primtype_nonstructured(int pt);
+void mdl_update_type_flags(int typenum);
+void mdl_rebuild_type_flags();
 mdl_value_t *mdl_get_evaltype(int typenum);
 mdl_value_t *mdl_get_applytype(int typenum);
 mdl_value_t *mdl_get_printtype(int typenum);
@@ -390,11 +500,22 @@ bool mdl_value_equal_atom(const mdl_value_t *a, const atom_t *b);
 bool mdl_string_equal_cstr(const counted_string_t *s, const char *cs);
 mdl_value_t *mdl_global_symbol_lookup(const atom_t *atom);
 mdl_value_t *mdl_local_symbol_lookup(atom_t *atom, mdl_frame_t *frame = cur_frame);
+mdl_value_t *mdl_bind_local_symbol(atom_t *atom, mdl_value_t *val, mdl_frame_t *frame, bool allow_replacement);
+void mdl_unbind_all_frames();
+void mdl_clear_frame_bindings(mdl_frame_t *frame);
 mdl_value_t *mdl_local_symbol_lookup_pname(const char *pname, mdl_frame_t *frame);
 mdl_value_t *mdl_both_symbol_lookup_pname(const char *pname, mdl_frame_t *frame);
 mdl_value_t *mdl_internal_apply(mdl_value_t *applier, mdl_value_t *apply_to, bool called_from_apply_subr);
 mdl_value_t *mdl_std_apply(mdl_value_t *applier, mdl_value_t *apply_to, int apply_as, bool called_from_apply_subr);
-mdl_value_t *mdl_eval_apply_expr(mdl_value_t *appl_expr);
+mdl_value_t *mdl_apply_built_in(mdl_value_t *applier, mdl_value_t *apply_to, mdl_value_t *arglist, struct mdl_code_t *code = nullptr);
+mdl_value_t *mdl_argstack_cons(mdl_value_t *a, mdl_value_t *b);
+mdl_value_t *mdl_argstack_make_list(mdl_value_t *l);
+mdl_value_t *mdl_argstack_copy_list(mdl_value_t *l);
+mdl_value_t *mdl_argstack_eval_args(mdl_value_t *rest);
+mdl_value_t *mdl_apply_function(mdl_value_t *applier, mdl_value_t *apply_to, bool called_from_apply_subr);
+mdl_value_t *mdl_internal_expand(mdl_value_t *arg, bool *read_globals = nullptr);
+mdl_value_t *mdl_internal_prog_repeat_bind(mdl_value_t *orig_form, bool bind_to_lastprog, bool repeat, struct mdl_code_t *code = nullptr);
+mdl_value_t *mdl_eval_apply_expr(mdl_value_t *appl_expr, const mdl_value_t *site = nullptr);
 mdl_value_t *mdl_std_eval(mdl_value_t *l, bool in_struct = false, int as_type = MDL_TYPE_NOTATYPE);
 mdl_value_t *mdl_new_mdl_value();
 mdl_value_t *mdl_set_lval(atom_t *a, mdl_value_t *val, mdl_frame_t *frame);
@@ -421,11 +542,14 @@ int mdl_eval_type(int t);
 int mdl_apply_type(int t);
 int mdl_print_type(int t);
 mdl_value_t *mdl_get_atom_default_oblist(const char *pname, bool insert_allowed, mdl_value_t *oblists);
+MDL_INT mdl_hash_pname(const char *pname);
 mdl_value_t *mdl_get_atom_from_oblist(const char *pname, mdl_value_t *oblist);
+mdl_value_t *mdl_get_atom_from_oblist(const char *pname, MDL_INT hash, mdl_value_t *oblist);
 mdl_value_t *mdl_create_atom_on_oblist(const char *pname, mdl_value_t *oblist);
 mdl_value_t *mdl_get_or_create_atom_on_oblist(const char *pname, mdl_value_t *oblist);
+void mdl_find_known_atoms(mdl_value_t *root_oblist, mdl_value_t *interrupts_oblist);
 atom_t *mdl_get_oblist_name(mdl_value_t *oblist);
-mdl_value_t *mdl_internal_eval_putprop(mdl_value_t *item, mdl_value_t *indicator, mdl_value_t *val);
+mdl_value_t *mdl_internal_eval_putprop(mdl_value_t *item, mdl_value_t *indicator, mdl_value_t *val, bool strong = false);
 mdl_value_t *mdl_internal_eval_getprop(mdl_value_t *item, mdl_value_t *indicator);
 mdl_value_t *mdl_new_empty_vector(int size, int type);
 mdl_value_t *mdl_new_empty_uvector(int size, int type);
@@ -458,6 +582,10 @@ mdl_value_t *mdl_next_character(mdl_value_t *chan);
 mdl_value_t *mdl_read_binary(mdl_value_t *chan, mdl_value_t *buffer);
 mdl_value_t *mdl_read_string(mdl_value_t *chan, mdl_value_t *buffer, mdl_value_t *stop);
 mdl_value_t *mdl_load_file_from_chan(mdl_value_t *chan);
+bool mdl_read_comment_applies(const mdl_value_t *item);
+mdl_value_t *mdl_get_read_comment(const mdl_value_t *item);
+void mdl_set_read_comment(mdl_value_t *item, mdl_value_t *comment);
+void mdl_set_chan_keeps_comments(mdl_value_t *chan, bool keep);
 int mdl_get_chan_radix(mdl_value_t *chan);
 bool mdl_chan_mode_is_print_binary(mdl_value_t *chan);
 bool mdl_chan_mode_is_read_binary(mdl_value_t *chan);
@@ -50,7 +50,7 @@ mdl_value_t *mdl_get_default_outchan()
     {
         frame = cur_process_initial_frame;
     }
-    return mdl_local_symbol_lookup_pname("OUTCHAN!-", frame);
+    return mdl_local_symbol_lookup(mdl_value_atom_outchan->v.a, frame);
 }
 
 mdl_value_t *mdl_create_default_outchan()
@@ -844,10 +844,6 @@ void mdl_print_list_to_chan(mdl_value_t *chan, const mdl_value_t *v, int print_a
     const char *endstr;
     bool specialform = false;
 
-    mdl_value_t *mdl_value_atom_lval = mdl_get_atom_from_oblist("LVAL", mdl_value_root_oblist);
-    mdl_value_t *mdl_value_atom_gval = mdl_get_atom_from_oblist("GVAL", mdl_value_root_oblist);
-    mdl_value_t *mdl_value_atom_quote = mdl_get_atom_from_oblist("QUOTE", mdl_value_root_oblist);
-
     if (print_as_type == MDL_TYPE_NOTATYPE)
     {
         print_as_type = v->type;
@@ -1111,6 +1107,7 @@ void mdl_print_value_to_chan(mdl_value_t *chan, mdl_value_t *v, bool princ,
                              bool prespace, mdl_value_t *oblists)
 {
     int print_as_type = MDL_TYPE_NOTATYPE;
+    mdl_check_stack();
 
     if (v == nullptr)
     {
@@ -1119,7 +1116,11 @@ void mdl_print_value_to_chan(mdl_value_t *chan, mdl_value_t *v, bool princ,
         return;
     }
 
-    mdl_value_t *printtype = mdl_get_printtype(v->type);
+    mdl_value_t *printtype = nullptr;
+    if (MDL_TYPE_FLAGS(v->type) & MDL_TYPE_FLAG_PRINTTYPE)
+    {
+        printtype = mdl_get_printtype(v->type);
+    }
     if (printtype && printtype->type != MDL_TYPE_ATOM)
     {
         mdl_value_t *arglist = mdl_cons_internal(v, nullptr);
@@ -489,7 +489,7 @@ mdl_value_t *mdl_get_default_inchan()
     {
         frame = cur_process_initial_frame;
     }
-    return mdl_local_symbol_lookup_pname("INCHAN!-", frame);
+    return mdl_local_symbol_lookup(mdl_value_atom_inchan->v.a, frame);
 }
 
 mdl_value_t *mdl_create_default_inchan()
@@ -1196,6 +1196,13 @@ mdl_value_t *mdl_advance_readstate(mdl_value_t *chan, readstate_t **rdstatep, MD
         if (obj && rdstate->typecode != MDL_TYPE_NOTATYPE)
         {
             // FIXME make sure primtype is valid
+            if (obj->pt == PRIMTYPE_WORD)
+            {
+                // may be one of the shared FIXes or CHARACTERs
+                mdl_value_t *nobj = mdl_new_mdl_value();
+                *nobj = *obj;
+                obj = nobj;
+            }
             obj->type = rdstate->typecode;
             rdstate->typecode = MDL_TYPE_NOTATYPE;
         }
@@ -1302,13 +1309,19 @@ mdl_value_t *mdl_advance_readstate(mdl_value_t *chan, readstate_t **rdstatep, MD
             rdstate = (*rdstatep = rdstate->prev);
             if (rdstate->statenum == READSTATE_COMMENT)
             {
-                if (rdstate->seqtype != SEQTYPE_SINGLE && rdstate->objects)
+                if (mdl_chan_flags_are_set(chan, ICHANNEL_NO_COMMENTS))
+                {
+                    // nobody will ask for it
+                }
+                else if (rdstate->seqtype != SEQTYPE_SINGLE && rdstate->objects)
                 {
-                    mdl_internal_eval_putprop(mdl_make_list(rdstate->lastitem), mdl_get_atom_from_oblist("COMMENT", mdl_value_root_oblist), obj);
+                    mdl_set_read_comment(mdl_make_list(rdstate->lastitem), obj);
                 }
                 else if ((rdstate->seqtype == SEQTYPE_SINGLE) && (rdstate->prev == nullptr))
                 {
-                    mdl_internal_eval_putprop(chan, mdl_get_atom_from_oblist("COMMENT", mdl_value_root_oblist), obj);
+                    // and replaces one the program put there
+                    mdl_internal_eval_putprop(chan, mdl_value_atom_comment, nullptr);
+                    mdl_set_read_comment(chan, obj);
                 }
                 obj = nullptr;
             }
@@ -1331,12 +1344,219 @@ mdl_value_t *mdl_advance_readstate(mdl_value_t *chan, readstate_t **rdstatep, MD
     return nullptr;
 }
 
+// COMMENT properties of lists and channels: the comments the reader
+// attaches to list elements, and to a channel for the object just read
+// from it.  They're kept here rather than as associations, as a
+// commented file would otherwise fill the association table with
+// entries nobody looks at.  A COMMENT given by PUTPROP is an ordinary
+// association, so SAVE keeps it, and it replaces the reader's (see
+// mdl_internal_eval_putprop).  Like associations, these don't keep what
+// they're attached to from being collected: the keys are in atomic
+// memory, with a disappearing link to the list's first cell or the
+// channel's vector.
+// Open addressing, with linear probing; a slot whose object has been
+// collected is as good as a deleted one
+#define MDL_READ_COMMENT_MIN_SLOTS 64
+#define MDL_READ_COMMENT_EMPTY 0
+#define MDL_READ_COMMENT_USED 1
+#define MDL_READ_COMMENT_DELETED 2
+
+struct mdl_read_comment_key_t
+{
+    mdl_value_t item; // a copy; compared, but not followed, once exists is clear
+    void *exists;     // (void *)1 until the item's object is collected
+    int state;
+};
+
+static mdl_read_comment_key_t *mdl_read_comment_keys;
+static mdl_value_t **mdl_read_comment_values;
+static int mdl_read_comment_slots;
+static int mdl_read_comment_used; // slots not empty
+
+// the object a comment's item stands for, or nullptr if it can't have
+// one here
+static void *mdl_read_comment_object(const mdl_value_t *item)
+{
+    void *obj = nullptr;
+    if (item->pt == PRIMTYPE_LIST)
+    {
+        obj = item->v.p.cdr;
+    }
+    else if (item->type == MDL_TYPE_CHANNEL)
+    {
+        obj = item->v.v.p;
+    }
+    // a disappearing link needs the start of a collectable object, which
+    // cells on the argument stack aren't
+    if (obj && GC_base(obj) != obj)
+    {
+        obj = nullptr;
+    }
+    return obj;
+}
+
+bool mdl_read_comment_applies(const mdl_value_t *item)
+{
+    return mdl_read_comment_object(item) != nullptr;
+}
+
+static bool mdl_read_comment_is_live(const mdl_read_comment_key_t *key)
+{
+    return key->state == MDL_READ_COMMENT_USED && key->exists;
+}
+
+static int mdl_read_comment_start(const mdl_value_t *item, int nslots)
+{
+    return (int)((mdl_hash_value(item) * 0x9E3779B97F4A7C15ULL >> 32) & (nslots - 1));
+}
+
+// the slot holding item's comment, or -1; *free_slot gets the first slot
+// on the way a new comment could go in
+static int mdl_find_read_comment(const mdl_value_t *item, int *free_slot)
+{
+    int mask = mdl_read_comment_slots - 1;
+    *free_slot = -1;
+    for (int slot = mdl_read_comment_start(item, mdl_read_comment_slots);; slot = (slot + 1) & mask)
+    {
+        mdl_read_comment_key_t *key = &mdl_read_comment_keys[slot];
+        if (key->state == MDL_READ_COMMENT_EMPTY)
+        {
+            if (*free_slot < 0)
+            {
+                *free_slot = slot;
+            }
+            return -1;
+        }
+        if (!mdl_read_comment_is_live(key))
+        {
+            if (*free_slot < 0)
+            {
+                *free_slot = slot;
+            }
+        }
+        else if (mdl_value_double_equal(&key->item, item))
+        {
+            return slot;
+        }
+    }
+}
+
+static void mdl_hold_read_comment_key(mdl_read_comment_key_t *key, const mdl_value_t *item)
+{
+    key->item = *item;
+    key->state = MDL_READ_COMMENT_USED;
+    key->exists = (void *)1;
+    GC_GENERAL_REGISTER_DISAPPEARING_LINK(&key->exists, mdl_read_comment_object(item));
+}
+
+// move the live comments into a table at least four times their number,
+// dropping deleted and collected ones
+static void mdl_rehash_read_comments()
+{
+    int live = 0;
+    for (int i = 0; i < mdl_read_comment_slots; i++)
+    {
+        if (mdl_read_comment_is_live(&mdl_read_comment_keys[i]))
+        {
+            live++;
+        }
+    }
+    int nslots = MDL_READ_COMMENT_MIN_SLOTS;
+    while (nslots < live * 4)
+    {
+        nslots *= 2;
+    }
+    mdl_read_comment_key_t *keys = (mdl_read_comment_key_t *)GC_MALLOC_ATOMIC(sizeof(mdl_read_comment_key_t) * nslots);
+    std::memset(keys, 0, sizeof(mdl_read_comment_key_t) * nslots);
+    mdl_value_t **values = (mdl_value_t **)GC_MALLOC(sizeof(mdl_value_t *) * nslots);
+    for (int i = 0; i < mdl_read_comment_slots; i++)
+    {
+        mdl_read_comment_key_t *key = &mdl_read_comment_keys[i];
+        if (!mdl_read_comment_is_live(key))
+        {
+            continue;
+        }
+        int slot = mdl_read_comment_start(&key->item, nslots);
+        while (keys[slot].state != MDL_READ_COMMENT_EMPTY)
+        {
+            slot = (slot + 1) & (nslots - 1);
+        }
+        GC_unregister_disappearing_link(&key->exists);
+        mdl_hold_read_comment_key(&keys[slot], &key->item);
+        values[slot] = mdl_read_comment_values[i];
+    }
+    mdl_read_comment_keys = keys;
+    mdl_read_comment_values = values;
+    mdl_read_comment_slots = nslots;
+    mdl_read_comment_used = live;
+}
+
+mdl_value_t *mdl_get_read_comment(const mdl_value_t *item)
+{
+    if (!mdl_read_comment_used)
+    {
+        return nullptr;
+    }
+    int free_slot;
+    int slot = mdl_find_read_comment(item, &free_slot);
+    return slot < 0 ? nullptr : mdl_read_comment_values[slot];
+}
+
+// a null comment removes the item's comment, if it has one
+void mdl_set_read_comment(mdl_value_t *item, mdl_value_t *comment)
+{
+    if (!mdl_read_comment_object(item) || (!comment && !mdl_read_comment_used))
+    {
+        return;
+    }
+    if (comment && mdl_read_comment_used >= mdl_read_comment_slots / 2)
+    {
+        mdl_rehash_read_comments();
+    }
+    int free_slot;
+    int slot = mdl_find_read_comment(item, &free_slot);
+    if (!comment)
+    {
+        if (slot >= 0)
+        {
+            mdl_read_comment_key_t *key = &mdl_read_comment_keys[slot];
+            GC_unregister_disappearing_link(&key->exists);
+            key->exists = nullptr;
+            key->state = MDL_READ_COMMENT_DELETED;
+            mdl_read_comment_values[slot] = nullptr;
+        }
+        return;
+    }
+    if (slot < 0)
+    {
+        slot = free_slot;
+        if (mdl_read_comment_keys[slot].state == MDL_READ_COMMENT_EMPTY)
+        {
+            mdl_read_comment_used++;
+        }
+        mdl_hold_read_comment_key(&mdl_read_comment_keys[slot], item);
+    }
+    mdl_read_comment_values[slot] = comment;
+}
+
+void mdl_set_chan_keeps_comments(mdl_value_t *chan, bool keep)
+{
+    if (keep)
+    {
+        mdl_clear_chan_flags(chan, ICHANNEL_NO_COMMENTS);
+    }
+    else
+    {
+        mdl_set_chan_flags(chan, ICHANNEL_NO_COMMENTS);
+    }
+}
+
 mdl_value_t *mdl_read_object(mdl_value_t *chan)
 {
     readstate_t *readstate = mdl_new_readstate(nullptr, SEQTYPE_SINGLE);
     mdl_value_t *result = nullptr;
 
-    mdl_internal_eval_putprop(chan, mdl_get_atom_from_oblist("COMMENT", mdl_value_root_oblist), nullptr);
+    mdl_set_read_comment(chan, nullptr);
     int curchar = mdl_read_from_chan(chan);
     while (!result && !mdl_chan_flags_are_set(chan, ICHANNEL_AT_EOF))
     {
@@ -41,7 +41,7 @@ extern const char no_warranty[] = "THERE IS NO WARRANTY FOR THIS PROGRAM, TO THE
  "IS WITH YOU.  SHOULD THE PROGRAM PROVE DEFECTIVE, YOU ASSUME THE COST OF\n"
  "ALL NECESSARY SERVICING, REPAIR OR CORRECTION.";
 
-const char *optstring = "r:";
+const char *optstring = "r:d:c";
 
 int main(int argc, char *argv[])
 {
@@ -63,6 +63,12 @@ int main(int argc, char *argv[])
                 exit(-1);
             }
             break;
+        case 'd':
+            mdl_set_max_frame_depth(std::strtoul(optarg, nullptr, 10));
+            break;
+        case 'c':
+            mdl_set_fload_comments(true);
+            break;
         }
     }
 